@@ -0,0 +1,220 @@
+/**
+ * @file lexbench.c
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief Lexer microbenchmark.
+ *
+ * Compares the scalar, SSE2 and AVX2 versions of the scan functions (see scan.h) on two generated sources :
+ * one where most of the bytes are comments (like testing/mult.s), one without any comment.
+ * For each source, it measures the bare scan (what the lexer does to find token boundaries) and the whole
+ * lex_load_file().
+ * Then lex_load_file() on 1 to 16 threads, on a source 8 times bigger : the speedup, and whether the tokens
+ * are those of one thread.
+ * Usage : make bench, or bench/lexbench [lines]
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <global.h>
+#include <notify.h>
+#include <functions.h>
+#include <lex.h>
+#include <scan.h>
+#include <arena.h>
+#include <inst.h>
+
+/* Globals normally defined by main.c */
+int testID = 0;
+__thread int section = UNDEFINED;
+__thread unsigned int addr = 0;
+__thread unsigned int line = 1;
+
+#define SCAN_ROUNDS 20
+
+static const char * sample[] = {
+	"  addi  $t2,$zero,-43",
+	"  DIV  $t2,$t3",
+	"  BEQ $t1,$zero, mult",
+	"loop_with_a_long_label_name:",
+	"  lw $t5,0($t2)",
+	"  add $t4,$t0,$t3",
+	"  J EXIT"
+};
+
+/**
+ * @param lines Number of lines to generate.
+ * @param comments TRUE to add a comment to most lines.
+ * @return A source buffer.
+ * @brief Generate an assembly source.
+ */
+
+static input generate( unsigned int lines, int comments ) {
+	input in = malloc( sizeof( *in ) );
+	size_t size = (size_t) lines * 128;
+	char * p;
+	unsigned int i;
+	int n;
+
+	in->name = comments ? "comment-heavy" : "comment-free";
+	in->data = malloc( size );
+	in->mapped = FALSE;
+	p = in->data;
+
+	for ( i = 0; i < lines; i++ ) {
+
+		if ( comments && i % 4 == 0 ) {
+			n = sprintf( p, "##----------------- section %u : what follows is explained here ------------\n", i );
+		}
+		else if ( comments ) {
+			n = sprintf( p, "%s\t\t\t# %u : comment at the end of the instruction line\n", sample[i % 7], i );
+		}
+		else {
+			n = sprintf( p, "%s\n", sample[i % 7] );
+		}
+
+		p += n;
+	}
+
+	in->size = p - in->data;
+
+	return in;
+}
+
+static double now( void ) {
+	struct timespec t;
+
+	clock_gettime( CLOCK_MONOTONIC, &t );
+
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/**
+ * @return Number of tokens found.
+ * @brief Find the token boundaries of the whole source the way the lexer does, without building lexemes.
+ */
+
+static unsigned long scan_only( input in ) {
+	char * p = in->data;
+	char * end = in->data + in->size;
+	unsigned long count = 0;
+
+	while ( p < end ) {
+		if ( *p == ' ' || *p == '\t' ) {
+			p += scan_blank( p, end - p );
+		}
+		else if ( *p == '#' ) {
+			p += scan_newline( p, end - p );
+		}
+		else {
+			count++;
+			p += 1 + scan_separator( p + 1, end - p - 1 );
+		}
+	}
+
+	return count;
+}
+
+/**
+ * @return A hash of what the lexer gives : types, values or atoms, lines.
+ */
+
+static unsigned long digest( tokens tok ) {
+	unsigned long h = 5381;
+	unsigned int k;
+
+	for ( k = 0; k < tok->count; k++ ) {
+		h = h * 33 + tok->type[k];
+		h = h * 33 + tok->lexeme[k].this.value;
+		h = h * 33 + tok->line[k];
+	}
+
+	for ( k = 0; k < tok->nlines; k++ ) {
+		h = h * 33 + tok->lines[k].line;
+		h = h * 33 + tok->lines[k].first;
+		h = h * 33 + tok->lines[k].count;
+	}
+
+	return h;
+}
+
+int main( int argc, char * argv[] ) {
+	unsigned int lines = ( argc > 1 ) ? atoi( argv[1] ) : 50000;
+	input in;
+	int comments, level, selected, r;
+	unsigned int nlines;
+	unsigned long found = 0;
+	unsigned long serial = 0;
+	unsigned int threads;
+	double t, scan, lex, bytes, alone = 0;
+	tokens tok;
+
+	printf( "%-14s %-7s %12s %12s %12s %12s\n", "source", "scanner", "scan MB/s", "lex MB/s", "lex ms", "bytes/token" );
+
+	for ( comments = TRUE; comments >= FALSE; comments-- ) {
+
+		in = generate( lines, comments );
+
+		for ( level = SCAN_SCALAR; level <= SCAN_AVX2; level++ ) {
+
+			selected = scan_init( level );
+
+			if ( selected != level ) {
+				printf( "%-14s %-7s %12s\n", in->name, scan_level_to_string( level ), "unsupported" );
+				continue;
+			}
+
+			t = now();
+			for ( r = 0; r < SCAN_ROUNDS; r++ ) {
+				found += scan_only( in );
+			}
+			scan = ( now() - t ) / SCAN_ROUNDS;
+
+			line = 1;
+			t = now();
+			tok = make_tokens( 0 );
+			lex_load_file( in, &nlines, tok, instructionSet( NULL ), 1 );
+			lex = now() - t;
+			/* Memory held by the token buffer, line table and copies excepted */
+			bytes = (double) tok->size * ( sizeof( *tok->type ) + sizeof( *tok->lexeme ) + sizeof( *tok->line ) ) / tok->count;
+			arena_free( &arenas[ARENA_LEX] );
+
+			printf( "%-14s %-7s %12.1f %12.1f %12.2f %12.1f\n", in->name, scan_level_to_string( level ),
+				in->size / scan / 1e6, in->size / lex / 1e6, lex * 1e3, bytes );
+		}
+
+		free( in->data );
+		free( in );
+	}
+
+	printf( "\n%-14s %-7s %12s %12s %12s %12s\n", "source", "threads", "lex MB/s", "lex ms", "speedup", "tokens" );
+
+	in = generate( 8 * lines, TRUE );
+	scan_init( SCAN_BEST );
+
+	for ( threads = 1; threads <= 16; threads *= 2 ) {
+		line = 1;
+		t = now();
+		tok = make_tokens( 0 );
+		lex_load_file( in, &nlines, tok, instructionSet( NULL ), threads );
+		lex = now() - t;
+
+		if ( threads == 1 ) {
+			alone = lex;
+			serial = digest( tok );
+		}
+
+		printf( "%-14s %-7u %12.1f %12.2f %12.2f %12s\n", in->name, threads, in->size / lex / 1e6, lex * 1e3,
+			alone / lex, digest( tok ) == serial ? "same" : "DIFFERENT" );
+
+		arena_free( &arenas[ARENA_LEX] );
+	}
+
+	free( in->data );
+	free( in );
+
+	/* Keep the scan loop from being optimised out */
+	return found == 0;
+}
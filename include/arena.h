@@ -0,0 +1,27 @@
+/**
+ * @file arena.h
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief Arena allocator.
+ *
+ * The objects of the assembler are never freed one by one : they are allocated in the arena of the phase
+ * that creates them, and an arena is released in one call.
+ */
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <stddef.h>
+#include <global.h>
+
+/* One arena per phase : lexing (token buffer, atoms) and decoding (instruction set, symbols, codes, relocations) */
+enum { ARENA_LEX, ARENA_SYN, ARENAS };
+
+/* Each thread has its own arenas, a thread that lexes a chunk of the source its own atoms (see lex.c) */
+extern __thread struct arena_t arenas[ARENAS];
+
+void * arena_alloc( arena, size_t );
+void * arena_realloc( arena, void *, size_t, size_t );
+void arena_free( arena );
+void arena_free_all( void );
+
+#endif /* _ARENA_H_ */
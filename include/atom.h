@@ -0,0 +1,29 @@
+/**
+ * @file atom.h
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief String interning.
+ *
+ * Symbols, labels and directives are turned into atoms as they are lexed : a 32-bit number
+ * given once per distinct name. Two names are equal if their atoms are equal, and each name is stored once.
+ */
+
+#ifndef _ATOM_H_
+#define _ATOM_H_
+
+#include <stddef.h>
+
+/* No name : atoms start at 1 */
+#define NO_ATOM 0
+
+/* Flag of a scratch atom, see atom_scratch() */
+#define ATOM_SCRATCH 0x80000000U
+
+unsigned int atom_intern( const char *, size_t );
+unsigned int atom_scratch( const char *, size_t );
+void atom_scratch_reset( void );
+
+char * atom_text( unsigned int );
+unsigned int atom_length( unsigned int );
+unsigned int atom_count( void );
+
+#endif /* _ATOM_H_ */
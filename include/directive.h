@@ -0,0 +1,19 @@
+/**
+ * @file directive.h
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief Directives.
+ *
+ * Used for the analysis of the directives.
+ */
+
+#ifndef _DIRECTIVE_H_
+#define _DIRECTIVE_H_
+
+#include <stdio.h>
+#include <global.h>
+
+directive findDirective( unsigned int );
+void decodeDirective( lex, unsigned int, symtab, segment * );
+void alignDirective( lex, segment * );
+
+#endif /* _DIRECTIVE_H_ */
@@ -14,17 +14,16 @@
 #include <stdio.h>
 #include <global.h>
 
-unsigned int eval( lex, int, chain *, chain );
-void solve( chain, chain , chain );
+unsigned int eval( lex, int, segment, symtab );
+unsigned int relocate( unsigned int, int, symbol, unsigned int );
+void solve( segment * );
 
-void addSymbol( char * , chain, int );
-symbol findSymbol( char * , chain );
-symbol readSymbol( chain );
-symbol createSymbol(char *, int );
+void addSymbol( unsigned int , symtab, int );
+symbol findSymbol( unsigned int , symtab );
+symbol * sortSymbols( symtab );
+symbol createSymbol( unsigned int, int );
 
-rel createRel( int type, char * value, symbol sym );
-void addRel( chain * r, int, char *, symbol );
-rel readRel( chain );
+void addRel( segment, int, symbol, int );
 
 
 
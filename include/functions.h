@@ -11,31 +11,23 @@
 /* Each function is detailed in functions.c */
 
 
-chain make_collection( void );
-chain add_chain_next( chain );
-chain add_chain_bottom( chain );
+void fill_lex( lex, unsigned int, char *, int );
+int registerToInt( const char *, size_t );
 
-digit make_digit( void );
-int OctalToDecimal(int octalNumber);
-lex make_lex( unsigned int, char *, int );
-void add_lex( chain , lex );
-unsigned int registerToInt( char * );
-unsigned int binaryToInt( char* s );
+tokens make_tokens( unsigned int );
+void reserve_tokens( tokens, unsigned int );
+void reserve_lines( tokens, unsigned int );
+lex add_token( tokens, unsigned int );
+void add_token_line( tokens, unsigned int, unsigned int );
 
+symtab make_symtab( void );
 
-lex read_lex( chain );
-chain read_next( chain );
-chain read_bottom( chain );
-
-/* Hash function */
-int hash( char *, int );
-
-/* String function */
-void majuscule(char *);
+segment make_segment( int );
+void reserve_segment( segment, unsigned int );
+void add_segment_row( segment, int, unsigned int );
 
 /* Free functions */
 void del_lex( lex );
-void del_chain( chain );
 
 
 #endif /* _FUNCTIONS_H */
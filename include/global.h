@@ -8,6 +8,9 @@
 #ifndef _GLOBAL_H
 #define _GLOBAL_H
 
+#include <stddef.h>
+#include <stdio.h>
+
 
 
 /**
@@ -17,7 +20,9 @@
  *
  * Usage: <br/>
  * <br/>
- * ./as-mips source.asm
+ * ./as-mips source.asm <br/>
+ * ./as-mips -s source.asm : one pass, in bounded memory, for very big sources (see stream.c) <br/>
+ * ./as-mips -j 8 source.asm : a big source is lexed, and its instructions encoded, by 8 threads (see lex.c, parallel.c)
  *
  *
  * @section sec3 What works
@@ -68,69 +73,202 @@
   \brief All enum definitions.
  */
 
-enum {INIT, DECIMAL_ZERO, BIT, DECIMAL, OCTO, HEXA, SYMBOL, COMMENT, REGISTER, DIRECTIVE, PUNCTUATION, LABEL, ERROR};
+enum {INIT, DECIMAL_ZERO, BIT, DECIMAL, OCTO, HEXA, SYMBOL, COMMENT, REGISTER, DIRECTIVE, PUNCTUATION, LABEL, STRING, ERROR, MNEMONIC};
 
 enum {UNSIGNED, SIGNED};
 
 enum {R, I, J, IB, I2};
 
-enum {UNDEFINED, TEXT, DATA, BSS};
+enum {UNDEFINED, TEXT, DATA, BSS, SECTIONS};
+
+/* Section of the symbols given a value by .equ : they are constants, not addresses */
+#define ABSOLUTE        SECTIONS
 
-enum { LIST_MODE, OBJECT_MODE, ELF_MODE, TEST_MODE };
+enum { LIST_MODE, OBJECT_MODE, ELF_MODE, TEST_MODE, STREAM_MODE };
 
 enum { NONE, R_MIPS_32, R_MIPS_26, R_MIPS_HI16, R_MIPS_LO16, RELATIVE };
 
-enum { WORD, BYTE};
+enum { WORD, BYTE, SPACE };
 
 
 /*!
-  \brief Type definition of digit.
+  \brief Source file loaded in memory. Lines are read as spans into data, nothing is copied.
  */
- 
-typedef struct digit_t {
-	unsigned int type;
-	int sign;
+
+typedef struct input_t {
+	char * name;
+
+	/* Whole file contents, not NUL terminated */
+	char * data;
+	size_t size;
+
+	/* TRUE if data comes from mmap, FALSE if it has been read into a malloc'd buffer */
+	int mapped;
+} *input;
+
+/*!
+  \brief Region of memory : objects are allocated by moving a pointer in big chunks, and all freed at once.
+ */
+
+typedef struct arena_t {
+	/* Free space of the current chunk */
+	char * ptr;
+	char * end;
 	
-	/* For debug purposes only, we keep all data */
-	union {
-		int integer;
-		int octo;
-		char * hexa;
-	}this;
+	/* Last chunk, each chunk starts with a pointer to the previous one */
+	void * chunk;
+	
+	/* Incremented each time the arena is freed : tells the users that their objects are gone */
+	unsigned int generation;
 	
-	unsigned int value;
-}* digit;
+	/* Bytes given by arena_alloc since the arena was last freed */
+	size_t used;
+} *arena;
 
 /*!
-  \brief Type definition of lex.
+  \brief Type definition of lex. Numbers and registers are evaluated by the lexer, names are interned (see atom.h).
  */
  
 typedef struct lexeme_t {
-	unsigned int type;
+	unsigned short type;
+	
+	/* Numbers : bits the value needs, and SIGNED if it is written with '-' (it then needs a sign bit), see literal.c */
+	unsigned char bits;
+	unsigned char sign;
 	
 	union {
-		digit digit;
-		char value[STRLEN];
+		/* DECIMAL_ZERO, BIT, DECIMAL, OCTO, HEXA : value, negative ones in complement of 2. REGISTER : register number */
+		unsigned int value;
+		
+		/* SYMBOL, LABEL, DIRECTIVE : atom of the token. Without the final ':' of a label. */
+		unsigned int atom;
+		
+		/* MNEMONIC : number of the instruction in the instruction set, see findInstId() */
+		unsigned int id;
 	}this;
 } *lex;
 
 /*!
-  \brief Instruction structure as is use in the instruction set.
+  \brief Type definition of a line of the token buffer : the tokens of the line are first, first+1 ... first+count-1.
+ */
+
+typedef struct stmt_t {
+	/* Line in the source code */
+	unsigned int line;
+	
+	unsigned int first;
+	unsigned int count;
+} *stmt;
+
+/*!
+  \brief Type definition of the token buffer, built by lex.c and read by syn.c.
+  Tokens are stored by columns : token i is type[i], lexeme[i], and lines[line[i]] is its line.
+  Only lines with at least one token are in the line table.
  */
 
-typedef struct inst_t {
+typedef struct tokens_t {
+	unsigned char * type;
+	struct lexeme_t * lexeme;
+	unsigned int * line;
+	unsigned int count;
+	unsigned int size;
+	
+	/* Line table */
+	struct stmt_t * lines;
+	unsigned int nlines;
+	unsigned int lsize;
+	
+	/* TRUE if the strings are scratch atoms, only kept until the next line is lexed (see atom_scratch()) */
+	int scratch;
+} *tokens;
+
+/*!
+  \brief Flag of the number of a coprocessor register ($f0-$f31), see registerToInt().
+ */
+#define REGISTER_FP     32
+
+/*!
+  \brief Maximum number of operands given by the special specifications of an instruction (rd, rs, rt, sa).
+ */
+#define INST_SPECIALS    4
+
+/*!
+  \brief Maximum number of instructions in the expansion of a pseudo-instruction, the instruction included.
+ */
+#define INST_EXPANSION   4
+
+/*!
+  \brief Instruction structure as is use in the instruction set. The set is read only data : compiled
+  in the binary (see isahash.h) or mapped from a table file (see instructionSet()).
+ */
+
+typedef const struct inst_t {
 	char name[16];
-	char opcode[16];
+	char opcode[8];
 	unsigned int op;
 	int type;
 	
-	/* Give indication about the waited operands in binary 
-	   For example : In R-type, 1010 if $rd and $rt in waited. */
+	/* Waited operands, bit k for the k-th digit of the operands in instSet.txt.
+	   For example : In R-type, 0110 if $rt and $rd are waited (rs rt rd sa). */
 	   
-	char operand[8];
-	char special[STRLEN];
+	unsigned int operands;
+	
+	/* Waited operands that are registers, same bits : the other ones are numbers (sa), or offsets which may be symbols */
+	unsigned int registers;
+	
+	/* Pseudo instruction : operands given to the encoder in place of the ones of the source, in the order
+	   they are read. -1 if the operands are the ones of the source. */
+	int nspecials;
+	struct special_t {
+		/* Index of the operand of the source, -1 for the constant lexeme */
+		int source;
+		struct lexeme_t lexeme;
+	} specials[INST_SPECIALS];
+	
+	/* Index of the instruction that follows in the expansion of a pseudo instruction, -1 if none */
+	int next;
+	
+	/* Index of the next mnemonic of the same slot, -1 if none : names which only differ by case, like Lw and LW */
+	int alt;
 } *inst;
 
+/*!
+  \brief Instruction set with its perfect hash, generated by tools/genisa from instSet.txt.
+ */
+
+typedef struct isa_t {
+	/* Slots of the perfect hash and buckets of its first level, with their displacements */
+	unsigned int nkeys;
+	unsigned int nbuckets;
+	const unsigned short * disp;
+	
+	/* Instructions : set[k] is the one of slot k, the other spellings of the names follow the slots */
+	unsigned int ninst;
+	inst set;
+	
+	/* Mapping of the table file, NULL for the built-in set */
+	void * map;
+	size_t size;
+} *isa;
+
+/*!
+  \brief Header of a table file written by "genisa -b". It is followed by the ninst instructions, then
+  by the nbuckets displacements. The file is only valid for the build that wrote it.
+ */
+
+#define ISA_MAGIC   "ISA5"
+
+struct isa_file_t {
+	char magic[4];
+	
+	/* sizeof( struct inst_t ) */
+	unsigned int entry;
+	
+	unsigned int nkeys;
+	unsigned int nbuckets;
+	unsigned int ninst;
+};
+
 /*!
   \brief : Symbol struture. Symbol contained in symTab.
  */
@@ -141,24 +279,47 @@ typedef struct symbol_t {
 	int section;
 	unsigned int addr;
 	
-	char value[STRLEN];
+	/* Name of the symbol, see atom.h */
+	unsigned int atom;
+	
+	/* TRUE if the symbol is declared by .globl or .extern */
+	int global;
+	
+	/* Stream mode : uses of the symbol waiting for its definition, see stream.c */
+	struct fixup_t * fixups;
 	
 } *symbol;
 
 /*!
-  \brief : Code struture. After decode, used to struture the chain list in order to build the binary code.
+  \brief : Symbol table. Symbols are found by name with an open addressing hash table.
  */
 
-typedef struct code_t {
+typedef struct symtab_t {
+	/* Symbols in order of first appearance. A symbol never moves once created */
+	symbol * sym;
+	unsigned int count;
+	unsigned int size;
+	
+	/* Hash table keyed by the atom of the name (linear probing) : 0 if the slot is free, index in sym + 1 otherwise */
+	unsigned int * slots;
+	unsigned int nslots;
+	
+} *symtab;
+
+/*!
+  \brief : Row of the listing : the code of a source line, in one section.
+ */
+
+struct row_t {
 	unsigned int line;
-	int section;
 	unsigned int addr;
-	int type; /* BYTE WORD ... */
 	
-	/* Decoded code */
-	unsigned int value;
+	/* Number of bytes */
+	unsigned int size;
 	
-}* code;
+	/* WORD : instructions or .word, printed one word per row. BYTE : a data run, printed 4 bytes per row. SPACE : zeros, printed on one row */
+	int type;
+};
 
 /*!
   \brief : Relocation struture.
@@ -174,48 +335,70 @@ typedef struct rel_t {
 	/* Target symbol */
 	symbol sym;
 	
-	/* Target code : Used to update code */
-	code * c;
+	/* TRUE if the code already holds the address of the symbol, defined before its use : the relocation is only kept for the output */
+	int solved;
 	
-	/* Relocation section origin */
+}* rel;
+
+/*!
+  \brief : Code of a section. After decode, the machine code is stored in a byte buffer indexed by address.
+ */
+
+typedef struct segment_t {
 	int section;
 	
-	/* Symbol to relocate */
-	char value[STRLEN];
+	/* Bytes of the section from address base, words are stored big endian. Nothing is stored for .bss, which only has a size */
+	unsigned char * data;
+	unsigned int base;
+	unsigned int size;
+	unsigned int capacity;
 	
-}* rel;
+	/* Stream mode : the bytes below base are written to out, the solved relocations to rels. NULL otherwise */
+	FILE * out;
+	FILE * rels;
+	
+	/* Line to address table, used by the listing */
+	struct row_t * rows;
+	unsigned int nrows;
+	unsigned int rsize;
+	
+	/* Relocations of the section, in address order */
+	struct rel_t * rel;
+	unsigned int nrel;
+	unsigned int relsize;
+	
+}* segment;
 
 /*!
-  \brief : Type definition of chain. To understand the signification of next / bottom, please read the documentation graphs.
+  \brief : Directive. What a directive does is described by its descriptor, found by the atom of its name (see directive.c).
  */
- 
-typedef struct chain_t {
+
+typedef const struct directive_t {
+	char * name;
 	
-	/* Start at 1. If 0, not defined */
-	unsigned int line;
+	/* Section the directive switches to, UNDEFINED if it stays in the current one */
+	int section;
 	
-	union {
-		struct chain_t *bottom;
-		lex bottom_lex;
-		inst bottom_ins;
-		symbol sym;
-		code c;
-		rel r;
-	}this;
+	/* The data of the directive starts at a multiple of align bytes */
+	unsigned int align;
+	
+	/* Bytes of each value given to the directive, 0 if it does not take values */
+	unsigned int width;
 	
-	struct chain_t *next;
+	/* Does the rest of the work with the operands of the directive, NULL if the section and the alignment are all */
+	void ( * handler )( const struct directive_t *, lex, unsigned int, symtab, segment * );
 	
-} *chain;
+} *directive;
 
 /*!
   \brief : A global variable is declared in all files. This variable is used to manage tests. It is defined in top of main.
+  The current section, address and line are those of the statement being decoded : each thread has its own (see parallel.c).
  */
 
 extern int testID;
-extern int section;
-extern unsigned int addr;
-extern unsigned int line;
-extern int typeCode;
+extern __thread int section;
+extern __thread unsigned int addr;
+extern __thread unsigned int line;
 
 #endif /* _GLOBAL_H */
 
@@ -0,0 +1,20 @@
+/**
+ * @file input.h
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief Source file loading.
+ *
+ * The whole source file is kept in one buffer (memory-mapped when possible)
+ * and handed to the lexer and to the listing as line spans into that buffer.
+ */
+
+#ifndef _INPUT_H_
+#define _INPUT_H_
+
+#include <stddef.h>
+#include <global.h>
+
+input input_open( char * );
+int input_line( input, size_t *, char **, size_t * );
+void input_close( input );
+
+#endif /* _INPUT_H_ */
@@ -13,7 +13,8 @@
 #include <stdio.h>
 #include <global.h>
 
-void instructionSet( inst* );
-inst makeInst( char*, char*, char*, char*, char*  );
+isa instructionSet( char * );
+void closeInstructionSet( isa );
+int findInstId( isa, const char *, size_t );
 
 #endif /* _INST_H_ */
@@ -0,0 +1,15 @@
+/**
+ * @file isahash.h
+ * @brief Built-in instruction set and its perfect hash.
+ *
+ * Generated by tools/genisa from instSet.txt. Do not edit : change the spec and run "make tables".
+ */
+
+#ifndef _ISAHASH_H_
+#define _ISAHASH_H_
+
+#include <global.h>
+
+extern struct isa_t isa_builtin;
+
+#endif /* _ISAHASH_H_ */
@@ -12,10 +12,10 @@
 
 
 #include <stdio.h>
+#include <global.h>
 
-void	lex_read_line( char *, int, chain);
-void	lex_load_file( char *, unsigned int *, chain );
-void	lex_standardise( char*, char*  );
+char*	lex_read_line( char *, char *, int, tokens, char **, size_t *, isa );
+void	lex_load_file( input, unsigned int *, tokens, isa, unsigned int );
 
 char*   state_to_string (int state);
 
@@ -0,0 +1,24 @@
+/**
+ * @file lexfsm.h
+ * @brief Lexeme FSM tables.
+ *
+ * Generated by tools/genfsm from lexFSM.txt. Do not edit : change the spec and run "make tables".
+ */
+
+#ifndef _LEXFSM_H_
+#define _LEXFSM_H_
+
+/* Character classes */
+enum { CLASS_OTHER, CLASS_BLANK, CLASS_NEWLINE, CLASS_MINUS, CLASS_HASH, CLASS_PUNCT, CLASS_COLON, CLASS_ZERO, CLASS_ONE, CLASS_OCT, CLASS_DEC, CLASS_X, CLASS_B, CLASS_HEX, CLASS_DOT, CLASS_DOLLAR, CLASS_QUOTE, LEX_CLASSES };
+
+/* States, the first one is the initial state */
+enum { STATE_INIT, STATE_DECIMAL_ZERO, STATE_BIT, STATE_DECIMAL, STATE_OCTO, STATE_HEXA, STATE_SYMBOL, STATE_LABEL, STATE_STRING, STATE_COMMENT, STATE_REGISTER, STATE_DIRECTIVE, STATE_PUNCTUATION, STATE_ERROR, LEX_STATES };
+
+extern const unsigned char lex_class[256];
+extern const unsigned char lex_next[LEX_STATES][LEX_CLASSES];
+extern const unsigned char lex_accept[LEX_STATES];
+extern const unsigned char lex_loop[LEX_STATES];
+extern const unsigned char lex_separator[256];
+extern const char lex_separators[];
+
+#endif /* _LEXFSM_H_ */
@@ -0,0 +1,17 @@
+/**
+ * @file literal.h
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief Numeric literals.
+ *
+ * Numbers are converted once by the lexer, which also records how many bits they need.
+ */
+
+#ifndef _LITERAL_H_
+#define _LITERAL_H_
+
+#include <global.h>
+
+void literal_read( lex, unsigned int, const char *, int );
+int literal_fits( lex, unsigned int, int );
+
+#endif /* _LITERAL_H_ */
@@ -0,0 +1,16 @@
+/**
+ * @file parallel.h
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief Decoding on several threads.
+ *
+ * Used in place of the fetch loop : the result is the same, the instructions are encoded in parallel.
+ */
+
+#ifndef _PARALLEL_H_
+#define _PARALLEL_H_
+
+#include <global.h>
+
+void parallel_fetch( tokens, symtab, segment *, isa, unsigned int );
+
+#endif /* _PARALLEL_H_ */
@@ -0,0 +1,20 @@
+/**
+ * @file pool.h
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief Pool of threads.
+ *
+ * Runs independent jobs, numbered from 0, on a given number of threads, or each on a new thread.
+ */
+
+#ifndef _POOL_H_
+#define _POOL_H_
+
+#include <global.h>
+
+/* Most threads a pool runs */
+#define POOL_MAX  64
+
+void pool_run( unsigned int, unsigned int, void ( * )( void *, unsigned int ), void * );
+void pool_each( unsigned int, void ( * )( void *, unsigned int ), void * );
+
+#endif /* _POOL_H_ */
@@ -10,7 +10,8 @@
  #ifndef _PRINT_H_
 #define _PRINT_H_
 
-void print( chain * c, int mode, int, char * );
+void print( symtab, segment *, int mode, int, input );
+void print_reloc( FILE *, unsigned int, int, symbol );
 
 char* section_to_string( int section );
 char* rel_to_string( int section );
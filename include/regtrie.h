@@ -0,0 +1,22 @@
+/**
+ * @file regtrie.h
+ * @brief Register name trie.
+ *
+ * Generated by tools/genreg from registers.txt. Do not edit : change the spec and run "make tables".
+ */
+
+#ifndef _REGTRIE_H_
+#define _REGTRIE_H_
+
+#define REG_CLASSES 37
+#define REG_STATES 110
+
+/* State after '$', and dead end */
+#define REG_ROOT 1
+#define REG_DEAD 0
+
+extern const unsigned char reg_class[256];
+extern const unsigned char reg_next[REG_STATES][REG_CLASSES];
+extern const signed char reg_value[REG_STATES];
+
+#endif /* _REGTRIE_H_ */
@@ -0,0 +1,26 @@
+/**
+ * @file scan.h
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief Bulk scanning of the source buffer.
+ *
+ * Used by the lexer to jump over runs of characters that do not change the current token :
+ * the inside of symbols, registers and directives, blanks and comments.
+ * The implementation (scalar, SSE2 or AVX2) is chosen at run time.
+ */
+
+#ifndef _SCAN_H_
+#define _SCAN_H_
+
+#include <stddef.h>
+
+enum { SCAN_BEST = -1, SCAN_SCALAR, SCAN_SSE2, SCAN_AVX2 };
+
+int scan_init( int );
+char * scan_level_to_string( int );
+
+/* Each function returns the number of bytes before the first match, len if there is none */
+extern size_t (*scan_separator)( const char *, size_t );
+extern size_t (*scan_blank)( const char *, size_t );
+extern size_t (*scan_newline)( const char *, size_t );
+
+#endif /* _SCAN_H_ */
@@ -0,0 +1,16 @@
+/**
+ * @file stream.h
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief One pass assembly.
+ *
+ * Used to assemble sources too big to be kept in memory.
+ */
+
+#ifndef _STREAM_H_
+#define _STREAM_H_
+
+#include <global.h>
+
+void stream( char *, isa, symtab, segment * );
+
+#endif /* _STREAM_H_ */
@@ -14,19 +14,18 @@
 #include <stdio.h>
 #include <global.h>
 
-/* For the chain structure, we use the same structure "chain" */
+/* Lexemes are read in the token buffer, symbols are stored in the symbol table, code and relocations in the segments */
 
-void decodeInstruction( chain ** , inst *);
-chain get_special( char *, chain, chain );
-void decodeDirective( chain ** );
+void decodeInstruction( unsigned int, lex, unsigned int, symtab, segment *, isa );
 
-void fetch( chain**, inst * );
-lex get_lex( chain * );
+unsigned int fetchLabels( tokens, unsigned int, unsigned int, symtab, segment * );
+void fetch( tokens, unsigned int, unsigned int, symtab, segment *, isa );
+lex get_lex( lex, unsigned int, unsigned int * );
 
-void addCode( chain *, unsigned int );
-code createCode(unsigned int, unsigned int );
-code getCode( chain );
-code findCode( chain, unsigned int );
+void addCode( segment, unsigned int );
+void addData( segment, int, unsigned char *, unsigned int );
+unsigned int getCode( segment, unsigned int );
+void setCode( segment, unsigned int, unsigned int );
 
 #endif /* _SYN_H_ */
 
@@ -0,0 +1,132 @@
+/**
+ * @file arena.c
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief Arena allocator.
+ *
+ * An arena is a list of chunks. Allocating is moving a pointer in the current chunk, a new chunk is
+ * taken when it is full. Freeing the arena frees its chunks : the cost does not depend on the number
+ * of objects.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <global.h>
+#include <notify.h>
+#include <arena.h>
+
+/* Size of a chunk. Bigger objects get a chunk of their own */
+#define ARENA_CHUNK  65536
+
+/* Alignment of the objects, enough for any type */
+#define ARENA_ALIGN  16
+
+/* Header of a chunk, rounded to the alignment */
+#define ARENA_HEADER  ( ( sizeof( void * ) + ARENA_ALIGN - 1 ) & ~(size_t) ( ARENA_ALIGN - 1 ) )
+
+/* Arenas of the phases, empty until their first allocation. One set per thread */
+__thread struct arena_t arenas[ARENAS];
+
+/**
+ * @param a The arena.
+ * @param size Size of the object.
+ * @return The object, aligned for any type. Its content is undefined.
+ * @brief Allocate an object in an arena.
+ */
+
+void * arena_alloc( arena a, size_t size ) {
+	char * chunk;
+	size_t n;
+	void * object;
+
+	size = ( size + ARENA_ALIGN - 1 ) & ~(size_t) ( ARENA_ALIGN - 1 );
+
+	if ( a->ptr == NULL || (size_t) ( a->end - a->ptr ) < size ) {
+		n = ( size > ARENA_CHUNK - ARENA_HEADER ) ? size + ARENA_HEADER : ARENA_CHUNK;
+		chunk = malloc( n );
+
+		/* Error Management */
+		if ( chunk == NULL ) {
+			ERROR_MSG("Memory error : Malloc failed.");
+		}
+
+		*(void **) chunk = a->chunk;
+		a->chunk = chunk;
+		a->ptr = chunk + ARENA_HEADER;
+		a->end = chunk + n;
+	}
+
+	object = a->ptr;
+	a->ptr += size;
+	a->used += size;
+
+	return object;
+}
+
+/**
+ * @param a The arena.
+ * @param object Object allocated in the arena, or NULL.
+ * @param old Size of the object.
+ * @param size New size.
+ * @return The object with its new size. Its first bytes are kept.
+ * @brief Grow an array. The last object of the chunk grows in place, others are copied and the old
+ * copy stays in the arena until it is freed : geometric growth wastes at most the size of the array.
+ */
+
+void * arena_realloc( arena a, void * object, size_t old, size_t size ) {
+	void * grown;
+
+	old = ( old + ARENA_ALIGN - 1 ) & ~(size_t) ( ARENA_ALIGN - 1 );
+	size = ( size + ARENA_ALIGN - 1 ) & ~(size_t) ( ARENA_ALIGN - 1 );
+
+	if ( object != NULL && (char *) object + old == a->ptr && (size_t) ( a->end - (char *) object ) >= size ) {
+		a->ptr = (char *) object + size;
+		a->used += size - old;
+		return object;
+	}
+
+	grown = arena_alloc( a, size );
+
+	if ( object != NULL ) {
+		memcpy( grown, object, old < size ? old : size );
+	}
+
+	return grown;
+}
+
+/**
+ * @param a The arena.
+ * @return nothing
+ * @brief Free all the objects of an arena at once. The arena can be used again.
+ */
+
+void arena_free( arena a ) {
+	void * chunk = a->chunk;
+	void * prev;
+
+	while ( chunk != NULL ) {
+		prev = *(void **) chunk;
+		free( chunk );
+		chunk = prev;
+	}
+
+	a->chunk = NULL;
+	a->ptr = NULL;
+	a->end = NULL;
+	a->used = 0;
+	a->generation++;
+}
+
+/**
+ * @return nothing
+ * @brief Free the arenas of all the phases : everything the assembler allocated for a source file.
+ */
+
+void arena_free_all( void ) {
+	int i;
+
+	for ( i = 0; i < ARENAS; i++ ) {
+		arena_free( &arenas[i] );
+	}
+}
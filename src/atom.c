@@ -0,0 +1,265 @@
+/**
+ * @file atom.c
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief String interning.
+ *
+ * Names are kept in an open addressing hash table (linear probing, FNV-1a hash) which gives their atom.
+ * The text of each name is stored once, NUL terminated, in the lexing arena : atom_text() can be kept
+ * until the arena is freed, which forgets every atom.
+ * Like the arenas, the table belongs to a thread : a thread that lexes a chunk of the source gives its own
+ * atoms, which are interned again in the table of the source when the chunks are put together (see lex.c).
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <global.h>
+#include <notify.h>
+#include <atom.h>
+#include <arena.h>
+
+/* Initial number of slots of the hash table, a power of 2 */
+#define ATOM_SLOTS  1024
+
+/* Atom number n is atoms[n] */
+static __thread struct atom_t {
+	char * text;
+	unsigned int len;
+	unsigned int hash;
+} * atoms = NULL;
+
+static __thread unsigned int natoms = 1; /* atoms[0] is NO_ATOM */
+static __thread unsigned int asize = 0;
+
+/* Hash table : 0 if the slot is free, an atom otherwise */
+static __thread unsigned int * slots = NULL;
+static __thread unsigned int nslots = 0;
+
+/* Scratch atoms : ATOM_SCRATCH + k is scratch[k], its text starts at scratch[k].at in stext */
+static __thread struct scratch_t {
+	unsigned int at;
+	unsigned int len;
+} * scratch = NULL;
+
+static __thread unsigned int nscratch = 0;
+static __thread unsigned int ssize = 0;
+
+static __thread char * stext = NULL;
+static __thread unsigned int stlen = 0;
+static __thread unsigned int stsize = 0;
+
+/* Generation of the arena the tables were allocated in */
+static __thread unsigned int generation = 0;
+
+/**
+ * @return FNV-1a hash of the name.
+ */
+
+static unsigned int atom_hash( const char * s, size_t len ) {
+	unsigned int h = 2166136261U;
+	size_t i;
+
+	for ( i = 0; i < len; i++ ) {
+		h = ( h ^ (unsigned char) s[i] ) * 16777619U;
+	}
+
+	return h;
+}
+
+/**
+ * @return The slot of the name : the slot of its atom if it is already interned, a free slot otherwise.
+ */
+
+static unsigned int atom_slot( const char * s, size_t len, unsigned int h ) {
+	unsigned int i = h & ( nslots - 1 );
+	struct atom_t * a;
+
+	while ( slots[i] != NO_ATOM ) {
+		a = &atoms[slots[i]];
+
+		if ( a->hash == h && a->len == len && !memcmp( a->text, s, len ) ) {
+			break;
+		}
+
+		i = ( i + 1 ) & ( nslots - 1 );
+	}
+
+	return i;
+}
+
+/**
+ * @brief Forget every atom if the lexing arena has been freed since the tables were allocated.
+ */
+
+static void atom_check( void ) {
+
+	if ( generation != arenas[ARENA_LEX].generation ) {
+		generation = arenas[ARENA_LEX].generation;
+		atoms = NULL;
+		natoms = 1;
+		asize = 0;
+		slots = NULL;
+		nslots = 0;
+		scratch = NULL;
+		nscratch = 0;
+		ssize = 0;
+		stext = NULL;
+		stlen = 0;
+		stsize = 0;
+	}
+}
+
+/**
+ * @brief Double the hash table, or create it. The old table stays in the arena.
+ */
+
+static void atom_grow( void ) {
+	unsigned int a, i;
+
+	nslots = nslots ? 2 * nslots : ATOM_SLOTS;
+	slots = arena_alloc( &arenas[ARENA_LEX], nslots * sizeof( *slots ) );
+	memset( slots, 0, nslots * sizeof( *slots ) );
+
+	for ( a = 1; a < natoms; a++ ) {
+		i = atoms[a].hash & ( nslots - 1 );
+
+		while ( slots[i] != NO_ATOM ) {
+			i = ( i + 1 ) & ( nslots - 1 );
+		}
+
+		slots[i] = a;
+	}
+}
+
+/**
+ * @return A copy of the name, NUL terminated, that will never move.
+ */
+
+static char * atom_store( const char * s, size_t len ) {
+	char * text = arena_alloc( &arenas[ARENA_LEX], len + 1 );
+
+	memcpy( text, s, len );
+	text[len] = '\0';
+
+	return text;
+}
+
+/**
+ * @param s Name, not necessarily NUL terminated.
+ * @param len Length of the name.
+ * @return The atom of the name. A new atom is given the first time the name is seen.
+ * @brief Intern a name.
+ */
+
+unsigned int atom_intern( const char * s, size_t len ) {
+	unsigned int h = atom_hash( s, len );
+	unsigned int i;
+
+	atom_check();
+
+	/* The table is kept at most half full */
+	if ( 2 * natoms >= nslots ) {
+		atom_grow();
+	}
+
+	i = atom_slot( s, len, h );
+
+	if ( slots[i] != NO_ATOM ) {
+		return slots[i];
+	}
+
+	if ( natoms >= asize ) {
+		atoms = arena_realloc( &arenas[ARENA_LEX], atoms, asize * sizeof( *atoms ), ( asize ? 2 * asize : ATOM_SLOTS / 2 ) * sizeof( *atoms ) );
+		asize = asize ? 2 * asize : ATOM_SLOTS / 2;
+	}
+
+	atoms[natoms].text = atom_store( s, len );
+	atoms[natoms].len = len;
+	atoms[natoms].hash = h;
+	slots[i] = natoms;
+
+	return natoms++;
+}
+
+/**
+ * @param s Text, not necessarily NUL terminated.
+ * @param len Length of the text.
+ * @return A scratch atom of the text.
+ * @brief Give a text an atom until atom_scratch_reset() : it is neither interned nor kept. The strings of a
+ * source assembled in one pass are not kept after their statement (see stream.c), so that the memory does
+ * not grow with them.
+ */
+
+unsigned int atom_scratch( const char * s, size_t len ) {
+
+	atom_check();
+
+	if ( nscratch == ssize ) {
+		scratch = arena_realloc( &arenas[ARENA_LEX], scratch, ssize * sizeof( *scratch ), ( ssize ? 2 * ssize : 16 ) * sizeof( *scratch ) );
+		ssize = ssize ? 2 * ssize : 16;
+	}
+
+	/* The old text stays in the arena until the lexing arena is freed : it is at most the longest line */
+	if ( stlen + len + 1 > stsize ) {
+		stext = arena_realloc( &arenas[ARENA_LEX], stext, stlen, 2 * ( stlen + len + 1 ) );
+		stsize = 2 * ( stlen + len + 1 );
+	}
+
+	memcpy( stext + stlen, s, len );
+	stext[stlen + len] = '\0';
+
+	scratch[nscratch].at = stlen;
+	scratch[nscratch].len = len;
+	stlen += len + 1;
+
+	return ATOM_SCRATCH | nscratch++;
+}
+
+/**
+ * @return nothing
+ * @brief Forget the scratch atoms : their room is used again by the next ones.
+ */
+
+void atom_scratch_reset( void ) {
+	nscratch = 0;
+	stlen = 0;
+}
+
+/**
+ * @param a An atom.
+ * @return The name, NUL terminated. Empty for NO_ATOM.
+ */
+
+char * atom_text( unsigned int a ) {
+
+	if ( a & ATOM_SCRATCH ) {
+		return stext + scratch[a & ~ATOM_SCRATCH].at;
+	}
+
+	return ( a == NO_ATOM ) ? "" : atoms[a].text;
+}
+
+/**
+ * @param a An atom.
+ * @return The length of the name.
+ */
+
+unsigned int atom_length( unsigned int a ) {
+
+	if ( a & ATOM_SCRATCH ) {
+		return scratch[a & ~ATOM_SCRATCH].len;
+	}
+
+	return ( a == NO_ATOM ) ? 0 : atoms[a].len;
+}
+
+/**
+ * @return The number of distinct names interned so far.
+ */
+
+unsigned int atom_count( void ) {
+	atom_check();
+
+	return natoms - 1;
+}
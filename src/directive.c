@@ -0,0 +1,401 @@
+/**
+ * @file directive.c
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief MIPS assembly directives.
+ *
+ * Each directive is described by a descriptor : the section it switches to, the alignment and the width
+ * of its data, and the handler of its operands. Descriptors are found by the atom of the directive with
+ * one hash and one compare. Adding a directive is adding a line to the table.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <global.h>
+#include <notify.h>
+#include <functions.h>
+
+#include <lex.h>
+#include <directive.h>
+#include <eval.h>
+#include <syn.h>
+#include <input.h>
+#include <atom.h>
+#include <arena.h>
+#include <literal.h>
+
+
+/* Largest power of 2 .align can ask for */
+#define ALIGN_MAX        16
+
+/* Slots of the registry, at least twice the number of directives */
+#define DIRECTIVE_BITS   6
+#define DIRECTIVE_SLOTS  ( 1U << DIRECTIVE_BITS )
+
+/**
+ * @param s The segment of the current section.
+ * @param boundary Alignment in bytes, a power of 2.
+ * @return nothing
+ * @brief Move the current address to the next multiple of boundary. The padding is zeros, it has no row in the listing.
+ */
+
+static void align( segment s, unsigned int boundary ) {
+	unsigned int aligned = ( addr + boundary - 1 ) & ~( boundary - 1 );
+
+	if ( aligned != addr ) {
+		reserve_segment( s, aligned );
+		addr = aligned;
+	}
+}
+
+/**
+ * @param d The directive.
+ * @param l Operand of the directive.
+ * @param symTab Symbol table.
+ * @return The value of the operand.
+ * @brief An operand which must be known now : a number, or a symbol given a value by .equ before.
+ */
+
+static unsigned int constant( directive d, lex l, symtab symTab ) {
+	symbol sym;
+
+	switch ( l->type ) {
+		case DECIMAL_ZERO :
+		case BIT :
+		case DECIMAL :
+		case OCTO :
+		case HEXA :
+			return l->this.value;
+
+		case SYMBOL :
+			sym = findSymbol( l->this.atom, symTab );
+
+			if ( sym != NULL && sym->section == ABSOLUTE ) {
+				return sym->addr;
+			}
+
+			ERROR_MSG("Syntax error : %s expects a constant, %s is not defined by .equ before", d->name, atom_text( l->this.atom ));
+		break;
+
+		default :
+			ERROR_MSG("Syntax error : %s expects a constant, not a %s", d->name, state_to_string( l->type ));
+		break;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief .word w1, ... wn : words, saved one by one. A symbol is relocated.
+ */
+
+static void data_word( directive d, lex args, unsigned int n, symtab symTab, segment * seg ) {
+	unsigned int k;
+
+	for ( k = 0; k < n; k++ ) {
+		addCode( seg[section], eval( &args[k], R_MIPS_32, seg[section], symTab ) );
+		addr = addr + d->width;
+	}
+}
+
+/**
+ * @brief .byte b1, ... bn and .half h1, ... hn : values of width bytes, big endian, saved as one run.
+ * The run is reserved first and the values are written in the segment : nothing is allocated per directive.
+ * Raise an error if a value does not fit, signed or not.
+ */
+
+static void data_values( directive d, lex args, unsigned int n, symtab symTab, segment * seg ) {
+	unsigned char * bytes;
+	unsigned int limit = 1U << ( 8 * d->width );
+	unsigned int value, k, b;
+
+	if ( n == 0 ) {
+		return;
+	}
+
+	addData( seg[section], BYTE, NULL, n * d->width );
+	bytes = seg[section]->data + addr - seg[section]->base;
+
+	/* Each value is evaluated at its own address : a symbol is relocated where its bytes are */
+	for ( k = 0; k < n; k++, addr = addr + d->width ) {
+		value = eval( &args[k], NONE, seg[section], symTab );
+
+		/* The width of a number is known since the lexer, a symbol is checked by its value */
+		if ( ( args[k].type == SYMBOL ) ? ( value >= limit && value < 0U - ( limit >> 1 ) ) : !literal_fits( &args[k], 8 * d->width, SIGNED ) ) {
+			ERROR_MSG("Decode error : %d does not fit in the %u bytes of %s", (int) value, d->width, d->name );
+		}
+
+		for ( b = 0; b < d->width; b++ ) {
+			bytes[k * d->width + b] = value >> ( 8 * ( d->width - 1 - b ) );
+		}
+	}
+}
+
+/**
+ * @param terminated 1 to save the final '\0' of each string, 0 otherwise.
+ * @brief Strings, one run per string.
+ */
+
+static void strings( directive d, lex args, unsigned int n, segment * seg, unsigned int terminated ) {
+	unsigned int k;
+
+	for ( k = 0; k < n; k++ ) {
+
+		if ( args[k].type != STRING ) {
+			ERROR_MSG("Syntax error : %s expects strings, not a %s", d->name, state_to_string( args[k].type ));
+		}
+
+		/* The text of the atom is already NUL terminated */
+		addData( seg[section], BYTE, (unsigned char *) atom_text( args[k].this.atom ), atom_length( args[k].this.atom ) + terminated );
+		addr = addr + atom_length( args[k].this.atom ) + terminated;
+	}
+}
+
+/**
+ * @brief .ascii s1, ... sn : strings without their final '\0'.
+ */
+
+static void data_ascii( directive d, lex args, unsigned int n, symtab symTab, segment * seg ) {
+	strings( d, args, n, seg, 0 );
+}
+
+/**
+ * @brief .asciiz s1, ... sn : strings and their final '\0'.
+ */
+
+static void data_asciiz( directive d, lex args, unsigned int n, symtab symTab, segment * seg ) {
+	strings( d, args, n, seg, 1 );
+}
+
+/**
+ * @brief .space n : n bytes initialized to 0, the only data of .bss.
+ */
+
+static void data_space( directive d, lex args, unsigned int n, symtab symTab, segment * seg ) {
+	unsigned int size;
+
+	if ( n == 0 ) {
+		return;
+	}
+
+	size = constant( d, &args[0], symTab );
+
+	if ( (int) size < 0 ) {
+		ERROR_MSG("Syntax error : .space expects a positive size");
+	}
+
+	addData( seg[section], SPACE, NULL, size );
+	addr = addr + size;
+}
+
+/**
+ * @brief .align n : the next data starts at a multiple of 2^n.
+ */
+
+static void data_align( directive d, lex args, unsigned int n, symtab symTab, segment * seg ) {
+	unsigned int power;
+
+	if ( n != 1 ) {
+		ERROR_MSG("Syntax error : .align expects one power of 2");
+	}
+
+	power = constant( d, &args[0], symTab );
+
+	if ( power > ALIGN_MAX ) {
+		ERROR_MSG("Syntax error : .align %u is more than .align %d", power, ALIGN_MAX);
+	}
+
+	align( seg[section], 1U << power );
+}
+
+/**
+ * @brief .incbin "file" : the bytes of a file, saved as one run.
+ */
+
+static void data_incbin( directive d, lex args, unsigned int n, symtab symTab, segment * seg ) {
+	input in;
+
+	if ( n != 1 || args[0].type != STRING ) {
+		ERROR_MSG("Syntax error : .incbin expects a file name");
+	}
+
+	in = input_open( atom_text( args[0].this.atom ) );
+
+	if ( in->size > 0 ) {
+		addData( seg[section], BYTE, (unsigned char *) in->data, in->size );
+		addr = addr + in->size;
+	}
+
+	input_close( in );
+}
+
+/**
+ * @brief .globl s1, ... sn and .extern s1, ... sn : symbols seen out of the source file. They are
+ * added to the symbol table, defined or not.
+ */
+
+static void symbol_global( directive d, lex args, unsigned int n, symtab symTab, segment * seg ) {
+	unsigned int k;
+
+	for ( k = 0; k < n; k++ ) {
+
+		if ( args[k].type != SYMBOL ) {
+			ERROR_MSG("Syntax error : %s expects symbols, not a %s", d->name, state_to_string( args[k].type ));
+		}
+
+		addSymbol( args[k].this.atom, symTab, 0 );
+		findSymbol( args[k].this.atom, symTab )->global = TRUE;
+	}
+}
+
+/**
+ * @brief .equ name, value : the symbol is a constant. Uses after the directive are replaced by the value,
+ * uses before it are patched with the other relocations and keep none. A .byte or .half can not use it before.
+ */
+
+static void symbol_equ( directive d, lex args, unsigned int n, symtab symTab, segment * seg ) {
+	symbol sym;
+
+	if ( n != 2 || args[0].type != SYMBOL ) {
+		ERROR_MSG("Syntax error : .equ expects a symbol and its value");
+	}
+
+	addSymbol( args[0].this.atom, symTab, 0 );
+	sym = findSymbol( args[0].this.atom, symTab );
+
+	if ( sym->section != UNDEFINED && sym->section != ABSOLUTE ) {
+		ERROR_MSG("Decode error : %s is already a label", atom_text( args[0].this.atom ));
+	}
+
+	sym->addr = constant( d, &args[1], symTab );
+	sym->section = ABSOLUTE;
+	sym->line = line;
+}
+
+/* Descriptors of the directives : name, section, alignment, width of the values, handler */
+static const struct directive_t directives[] = {
+	{ ".text",   TEXT,      1, 0, NULL },
+	{ ".data",   DATA,      1, 0, NULL },
+	{ ".bss",    BSS,       1, 0, NULL },
+	{ ".set",    UNDEFINED, 1, 0, NULL },
+	{ ".word",   UNDEFINED, 4, 4, data_word },
+	{ ".half",   UNDEFINED, 2, 2, data_values },
+	{ ".byte",   UNDEFINED, 1, 1, data_values },
+	{ ".ascii",  UNDEFINED, 1, 1, data_ascii },
+	{ ".asciiz", UNDEFINED, 1, 1, data_asciiz },
+	{ ".space",  UNDEFINED, 1, 0, data_space },
+	{ ".align",  UNDEFINED, 1, 0, data_align },
+	{ ".incbin", UNDEFINED, 1, 1, data_incbin },
+	{ ".globl",  UNDEFINED, 1, 0, symbol_global },
+	{ ".extern", UNDEFINED, 1, 0, symbol_global },
+	{ ".equ",    UNDEFINED, 1, 0, symbol_equ }
+};
+
+#define DIRECTIVES  ( sizeof( directives ) / sizeof( *directives ) )
+
+/* Registry : atom of the name of each directive (NO_ATOM if the slot is free) and its descriptor */
+static unsigned int keys[DIRECTIVE_SLOTS];
+static directive slots[DIRECTIVE_SLOTS];
+
+/* Atoms are forgotten with the lexing arena : the registry is built again for the next source file */
+static unsigned int generation = 0;
+static int built = FALSE;
+
+/**
+ * @return The slot of the atom, or the free slot where it goes (linear probing).
+ */
+
+static unsigned int directive_slot( unsigned int atom ) {
+	unsigned int i = ( atom * 2654435761U ) >> ( 32 - DIRECTIVE_BITS );
+
+	while ( keys[i] != NO_ATOM && keys[i] != atom ) {
+		i = ( i + 1 ) & ( DIRECTIVE_SLOTS - 1 );
+	}
+
+	return i;
+}
+
+/**
+ * @return nothing
+ * @brief Intern the names of the directives and put their descriptors in the registry.
+ */
+
+static void directive_build( void ) {
+	unsigned int i, atom;
+
+	memset( keys, 0, sizeof( keys ) );
+
+	for ( i = 0; i < DIRECTIVES; i++ ) {
+		atom = atom_intern( directives[i].name, strlen( directives[i].name ) );
+		keys[directive_slot( atom )] = atom;
+		slots[directive_slot( atom )] = &directives[i];
+	}
+
+	generation = arenas[ARENA_LEX].generation;
+	built = TRUE;
+}
+
+/**
+ * @param atom Atom of the directive, '.' included.
+ * @return The descriptor of the directive, NULL if it is unknown.
+ * @brief One hash and one compare.
+ */
+
+directive findDirective( unsigned int atom ) {
+	unsigned int i;
+
+	if ( !built || generation != arenas[ARENA_LEX].generation ) {
+		directive_build();
+	}
+
+	i = directive_slot( atom );
+
+	return ( keys[i] == atom ) ? slots[i] : NULL;
+}
+
+/**
+ * @param l Lexemes of the directive in the token buffer, starting with the directive itself.
+ * @param n Number of lexemes.
+ * @param symTab Symbol table.
+ * @param seg Segments of the sections, indexed by section.
+ * @return nothing.
+ * @brief Switch section and align as the descriptor says, then let its handler read the operands.
+ * Data directives add one run per directive (per string for .ascii and .asciiz), whatever their number of bytes.
+ */
+
+void decodeDirective( lex l, unsigned int n, symtab symTab, segment * seg ) {
+	directive d = findDirective( l->this.atom );
+
+	if ( d == NULL ) {
+		ERROR_MSG("Decode error : directive %s unknown", atom_text( l->this.atom ));
+	}
+
+	if ( d->section != UNDEFINED ) {
+		section = d->section;
+		addr = seg[section]->size;
+	}
+
+	if ( d->align > 1 ) {
+		align( seg[section], d->align );
+	}
+
+	if ( d->handler != NULL ) {
+		d->handler( d, l + 1, n - 1, symTab, seg );
+	}
+}
+
+/**
+ * @param l The directive following a label.
+ * @param seg Segments of the sections, indexed by section.
+ * @return nothing
+ * @brief Align before the label is defined : the label is the address of the data, not of the padding.
+ */
+
+void alignDirective( lex l, segment * seg ) {
+	directive d = findDirective( l->this.atom );
+
+	if ( d != NULL && d->section == UNDEFINED && d->align > 1 ) {
+		align( seg[section], d->align );
+	}
+}
@@ -19,40 +19,78 @@
 
 #include <eval.h>
 #include <syn.h>
+#include <atom.h>
+#include <arena.h>
+
+/**
+ * @param sym Target symbol, defined.
+ * @param at Address of the branch.
+ * @return Number of words from the delay slot to the symbol, negative ones in complement of 2.
+ */
+
+static unsigned int branch_offset( symbol sym, unsigned int at ) {
+	return (unsigned int) ( (int) ( sym->addr - at - 4 ) / 4 );
+}
 
 /**
  * @param l lexeme to eval
+ * @param typeRel Type of the relocation added if the lexeme is a symbol.
+ * @param s Segment of the current section, which receives the relocation.
+ * @param symTab Symbol table.
  * @return An int that results from eval.
- * @brief This routine analyze the lexeme.
+ * @brief This routine analyze the lexeme. A symbol defined before its use is solved at once : a branch in
+ * its own section needs no relocation at all, the other ones are kept for the output but left to solve()
+ * only when the symbol is defined later, or never.
  *
  */
  
-unsigned int eval( lex l, int typeRel, chain * r, chain symTab) {
+unsigned int eval( lex l, int typeRel, segment s, symtab symTab) {
  	
  	symbol sym;
  	
  	/* We start by analysing lexeme type, in this function, we only treat digits */
  	switch (l->type) {
  		case DECIMAL_ZERO :
+ 		case BIT :
  		case DECIMAL :
  		case OCTO :
  		case HEXA :
  			/* Lexeme is a digit */
- 			return l->this.digit->value;
+ 			return l->this.value;
  		break;
  		
  		case SYMBOL :
  			/* If we are in symbol case : try to find symbol in symTab. If found, add a complete relocation. If not, add an entry in symTab and another in relocation table. */
- 			sym = findSymbol( l->this.value, symTab );
+ 			sym = findSymbol( l->this.atom, symTab );
  			
  			if (sym == NULL) { /* If symbol is not yet defined */
- 				addSymbol( l->this.value , symTab, 0);
- 				sym = findSymbol( l->this.value, symTab );
+ 				addSymbol( l->this.atom , symTab, 0);
+ 				sym = findSymbol( l->this.atom, symTab );
+ 			}
+ 			
+ 			/* Defined later, the symbol is solved with the other relocations. The table may already know it if the code is encoded after the labels (see parallel.c) : its line tells */
+ 			if ( sym->section == UNDEFINED || sym->line > line ) {
+ 				addRel( s, typeRel, sym, FALSE );
+ 				break;
+ 			}
+ 			
+ 			/* A constant given by .equ before is not relocated */
+ 			if ( sym->section == ABSOLUTE ) {
+ 				return sym->addr;
  			}
  			
+ 			/* A backward branch : its offset is known */
+ 			if ( typeRel == RELATIVE && sym->section == section ) {
+ 				return branch_offset( sym, addr );
+ 			}
  			
- 			addRel( r, typeRel, l->this.value, sym);
+ 			/* The address is known : the code holds it now, the relocation is for the output. Bytes are not relocated */
+ 			if ( typeRel != RELATIVE && typeRel != NONE ) {
+ 				addRel( s, typeRel, sym, TRUE );
+ 				return relocate( 0, typeRel, sym, addr );
+ 			}
  			
+ 			addRel( s, typeRel, sym, FALSE );
  			
  		break;
  		
@@ -64,76 +102,105 @@ unsigned int eval( lex l, int typeRel, chain * r, chain symTab) {
  	return 0;
  }
  
+/**
+ * @param code The word to update.
+ * @param type Type of the relocation.
+ * @param sym Target symbol.
+ * @param at Address of the word in its section.
+ * @return The word with the address of the symbol.
+ * @brief Apply one relocation to the code it points to.
+ */
+
+unsigned int relocate( unsigned int code, int type, symbol sym, unsigned int at ) {
+	unsigned int offset;
+	
+	switch (type) {
+		case R_MIPS_32 :
+			code = sym->addr;
+		break;
+		
+		case R_MIPS_26 :
+			code = code + ((sym->addr) >> 2);
+		break;
+		
+		case R_MIPS_HI16 :
+			code = code + ((sym->addr) >> 16);
+		break;
+		
+		case R_MIPS_LO16 :
+			code = code + (((sym->addr) << 16) >> 16);
+		break;
+		
+		case RELATIVE :
+			offset = branch_offset( sym, at );
+			
+			/* As the offset of a backward branch, see fits() in syn.c */
+			if ( offset >= 0x8000 && offset < 0xFFFF8000 ) {
+				ERROR_MSG("Decode error : %d does not fit in the %u bits of the field", (int) offset, 16 );
+			}
+			
+			code = code + ( offset & 0xFFFF );
+		break;
+		
+		default :
+		break;
+	}
+	
+	return code;
+}
+
  /**
- * @param 
+ * @param seg Segments of the sections, indexed by section.
  * @return Nothing.
  * @brief The aim is to solve in the end all the possible relocations. It means that sometimes, some LABELs will still be not defined. 
  * According to type, the relocation will be solved using the symbol table. It is mandatory to have a well working symTable.
+ * Each segment solves its own relocations : the code to update is read directly at the address of the relocation,
+ * and relative relocations are removed from the table in the same pass, as the ones of a constant given by .equ
+ * after its use. Relocations solved by eval() are skipped.
  *
  */
 
-void solve( chain symTab, chain chCode, chain chRel ) {
+void solve( segment * seg ) {
+	segment s;
 	rel r;
-	chain lastR = chRel;
-	code c;
+	unsigned int i, kept;
+	int k;
 	symbol sym;
 	
-	chRel = read_next( chRel );
-	chCode = read_next( chCode );
-	
-	while (chRel != NULL){
-		r = readRel( chRel );
-		
-		
-		c = findCode( chCode, r->addr );
-		sym = r->sym;
-		
-		if( c != NULL ) {
+	for ( k = 0; k < SECTIONS; k++ ) {
+		s = seg[k];
+		kept = 0;
 		
-			/* The symbol is already linked into the relocation structure ! There is any more to do except update the code. */
+		for ( i = 0; i < s->nrel; i++ ) {
+			r = &s->rel[i];
+			sym = r->sym;
 			
-			switch (r->type) {
-				case R_MIPS_32 :
-					c->value = sym->addr;
-					lastR = chRel;
-				break;
-		
-				case R_MIPS_26 :
-					c->value = c->value + ((sym->addr) >> 2);
-				break;
-		
-				case R_MIPS_HI16 :
-					c->value = c->value + ((sym->addr) >> 16);
-				break;
-		
-				case R_MIPS_LO16 :
-					c->value = c->value + (((sym->addr) << 16) >> 16);
-				break;
-		
-				case RELATIVE : /* For relative relocations we delete theme from the rel chain ! */
-					c->value = c->value + (((((sym->addr - c->addr) << 16) >> 16) >> 2) - 1);
-					lastR->next = read_next(chRel); /* We eat this one */
-				break;
-		
-				default :
-				break;
+			/* A constant of .equ is only known once defined : bytes can not be patched, see data_values() */
+			if ( r->type == NONE && sym->section == ABSOLUTE ) {
+				ERROR_MSG("Decode error : %s is used before its .equ", atom_text( sym->atom ));
 			}
 			
-			switch (r->type) {
-				case RELATIVE : /* Do nothing for this one */
-				break;
-		
-				default :
-					lastR = chRel;
-				break;
+			/* Bytes are not relocated */
+			if ( r->type != NONE && !r->solved ) {
+			
+				if ( k == BSS || r->addr + 4 > s->size ) {
+					ERROR_MSG("Internal error : A relocation failed due to unfindable code. Please contact devs.");
+				}
+				
+				/* The symbol is already linked into the relocation structure ! There is any more to do except update the code. */
+				
+				setCode( s, r->addr, relocate( getCode( s, r->addr ), r->type, sym, r->addr ) );
+			}
+			
+			/* For relative relocations we delete theme from the table ! A constant is not relocated either */
+			if ( r->type != RELATIVE && sym->section != ABSOLUTE ) {
+				s->rel[kept++] = *r;
 			}
-		}
-		else {
-			ERROR_MSG("Internal error : A relocation failed due to unfindable code. Please contact devs.");
 		}
 		
-		chRel = read_next(chRel);
+		s->nrel = kept;
 	}
+	
 	return;
 }
  
@@ -142,142 +209,160 @@ void solve( chain symTab, chain chCode, chain chRel ) {
 
 
 /**
- * @param value String value of symbol
+ * @param value Atom of the symbol
+ * @return The hash of the atom : atoms are dense, the multiplication spreads them over the table.
+ */
+
+static unsigned int symbol_hash( unsigned int value ) {
+	return value * 2654435761U;
+}
+
+/**
+ * @param value Atom of the symbol
+ * @param symTab Table of symbols
+ * @return The slot of the symbol, or the free slot where it would be.
+ */
+
+static unsigned int symbol_slot( unsigned int value, symtab symTab ) {
+	unsigned int mask = symTab->nslots - 1;
+	unsigned int i = symbol_hash( value ) & mask;
+	
+	while ( symTab->slots[i] != 0 && symTab->sym[symTab->slots[i] - 1]->atom != value ) {
+		i = ( i + 1 ) & mask;
+	}
+	
+	return i;
+}
+
+/**
+ * @param symTab Table of symbols
+ * @return nothing
+ * @brief Double the hash table, or create it. The old table stays in the arena.
+ */
+
+static void symbol_grow( symtab symTab ) {
+	unsigned int k;
+	
+	symTab->nslots = symTab->nslots ? 2 * symTab->nslots : 256;
+	symTab->slots = arena_alloc( &arenas[ARENA_SYN], symTab->nslots * sizeof( *symTab->slots ) );
+	memset( symTab->slots, 0, symTab->nslots * sizeof( *symTab->slots ) );
+	
+	for ( k = 0; k < symTab->count; k++ ) {
+		symTab->slots[symbol_slot( symTab->sym[k]->atom, symTab )] = k + 1;
+	}
+}
+
+/**
+ * @param value Atom of the symbol
  * @param symTab Table to complete
- * @param section Section identified
- * @param addr Address in section
  * @param label Boolean that explicit if we work with a label.
  * @return nothing
  * @brief Add the symbol to the table of symbols. Two path for resolution :
- * - if section is not defined, just add
- * - if section defined, add section and addr 
+ * - if it is only used, just add it once, undefined
+ * - if it is a label, add or update its section, addr and line.
  */
 
-void addSymbol( char * value, chain symTab, int label ) {
-	chain element = symTab;
-	chain foundElement = symTab;
-	chain lastElement = symTab;
+void addSymbol( unsigned int value, symtab symTab, int label ) {
 	symbol temp;
+	unsigned int i;
 	
+	if ( label && section == UNDEFINED ) {
+		ERROR_MSG("Decode error : no section defined yet, symbol can not be added");
+	}
 	
-	/* If we are managing a label, we search if there is any previous entry to updae it. If not, add a new one. */
-	if (label) {
+	/* The table is kept at most half full */
+	if ( 2 * ( symTab->count + 1 ) > symTab->nslots ) {
+		symbol_grow( symTab );
+	}
 	
-		if ( section != UNDEFINED ) { /* In case of no section/addr filled, we just add the symbol to the tab */
+	i = symbol_slot( value, symTab );
 	
-			temp = findSymbol( value, symTab );
+	if ( symTab->slots[i] != 0 ) {
+		temp = symTab->sym[symTab->slots[i] - 1];
 		
-			/* If we have a match we update the symbol by putting it in the good place : */
-			if (temp != NULL) {
-				/* We start by updating symbol */
-				temp->section = section;
-				temp->addr = addr;
-				temp->line = line;
-				
-				/* After that, we put the symbol in the right place */ 
-				while ( element != NULL && element->this.sym != temp ) {
-					lastElement = element;
-					element = read_next( element );
-				}
-				
-				foundElement = element;
-				
-				/* pull it from the chain */
-				lastElement->next = read_next( foundElement );
-				
-				element = symTab;
-				
-				while ( element != NULL && element->line < line ) {
-					lastElement = element;
-					element = read_next( element );
-				}
-				
-				lastElement->next = foundElement;
-				foundElement->next = element;
-				
-			
-			}
-			else {
-				/* Create a new element of the chain and add the symbol */
-				while ( read_next(element)  != NULL ) 
-					element = read_next(element);
-				
-				element = add_chain_next( element );
-				element->this.sym = createSymbol( value, 1 );
-			
-			}
+		/* If we have a match for a label we update the symbol. Its place in the listing is given by its line. */
+		if (label) {
+			temp->section = section;
+			temp->addr = addr;
+			temp->line = line;
 		}
-		else {
-			ERROR_MSG("Decode error : no section defined yet, symbol can not be added");
-		}
-	}
-	else {
-		/* In this case, we only need to add a simple entry */
-		temp = findSymbol( value, symTab );
 		
-		/* If we have a match we update the symbol : */
-		if (temp == NULL) {
-			/* Create a new element of the chain and add the symbol */
-			while ( read_next(element)  != NULL ) 
-				element = read_next(element);
-			
-			element = add_chain_next( element );
-			
-			element->this.sym = createSymbol( value, 0 );
-		
-		}
+		return;
 	}
 	
+	if ( symTab->count == symTab->size ) {
+		symTab->sym = arena_realloc( &arenas[ARENA_SYN], symTab->sym, symTab->size * sizeof( *symTab->sym ), ( symTab->size ? 2 * symTab->size : 64 ) * sizeof( *symTab->sym ) );
+		symTab->size = symTab->size ? 2 * symTab->size : 64;
+	}
+	
+	symTab->sym[symTab->count++] = createSymbol( value, label );
+	symTab->slots[i] = symTab->count;
+	
 	return;
 }
 
 /**
- * @param value String value of symbol
+ * @param value Atom of the symbol
  * @param symTab Table of symbols
  * @return the symbol if found, NULL if not.
  * @brief Find a symbol. Usefull when an operand is decoded for instance.
  */
 
-symbol findSymbol( char * value, chain symTab ) {
-	chain element = symTab;
-	symbol temp;
+symbol findSymbol( unsigned int value, symtab symTab ) {
+	unsigned int i;
 	
-	do {
-		temp = readSymbol( element );
-		if ( temp != NULL && !strcmp( temp->value, value ) ) {
-			return temp;
-		}
-	} while ( (element = read_next( element )) != NULL );
+	if ( symTab->nslots == 0 ) {
+		return NULL;
+	}
 	
-	return NULL;
+	i = symbol_slot( value, symTab );
+	
+	return symTab->slots[i] ? symTab->sym[symTab->slots[i] - 1] : NULL;
 }
 
 /**
- * @param symTab Element of symTab.
- * @return readed symbol, NULL if nothing to read.
- * @brief Read a symbol from a chain element.
+ * @return The order of two symbols in the listing : by line, then by first appearance.
  */
 
-symbol readSymbol( chain symElem ) {
-	if ( symElem->this.sym != NULL ) {
-		return symElem->this.sym;
+static int symbol_cmp( const void * a, const void * b ) {
+	symbol x = *(const symbol *) a;
+	symbol y = *(const symbol *) b;
+	
+	if ( x->line != y->line ) {
+		return x->line < y->line ? -1 : 1;
 	}
-	return NULL;
+	
+	return x < y ? -1 : ( x > y );
+}
+
+/**
+ * @param symTab Table of symbols
+ * @return The symbols sorted by line, a copy in the arena : the table itself is not changed.
+ * @brief Order the symbols once, for the listing.
+ */
+
+symbol * sortSymbols( symtab symTab ) {
+	symbol * sorted = arena_alloc( &arenas[ARENA_SYN], ( symTab->count + 1 ) * sizeof( *sorted ) );
+	
+	memcpy( sorted, symTab->sym, symTab->count * sizeof( *sorted ) );
+	qsort( sorted, symTab->count, sizeof( *sorted ), symbol_cmp );
+	
+	return sorted;
 }
 
 /**
  * @param section Symbol section, if UNDEFINED, symbol not defined.
  * @param addr If section defined, this value have a meaning.
- * @param value Symbol value
+ * @param value Atom of the symbol
  * @param label Boolean that explicit if we work with a label.
  * @return symbol.
  * @brief Create a symbol.
  */
 
-symbol createSymbol(char * value, int label ) {
-	symbol sym = malloc ( sizeof( *sym ) );
+symbol createSymbol(unsigned int value, int label ) {
+	symbol sym = arena_alloc( &arenas[ARENA_SYN], sizeof( *sym ) );
 	
-	strcpy(sym->value , value);
+	sym->atom = value;
 	
 	if (label) {
 		sym->section = section;
@@ -289,6 +374,8 @@ symbol createSymbol(char * value, int label ) {
 	}
 	
 	sym->line = line;
+	sym->global = FALSE;
+	sym->fixups = NULL;
 	
 	return sym;
 }
@@ -297,69 +384,28 @@ symbol createSymbol(char * value, int label ) {
  /* ##### Relocation functions ##### */
 
 /**
- * @param addr Address of relocation
+ * @param s Segment of the current section.
  * @param type of relocation
- * @return
- * @brief 
+ * @param sym Target symbol.
+ * @param solved TRUE if the code already holds the address of the symbol.
+ * @return nothing
+ * @brief Add a relocation at the current address. Relocations are added in address order.
  */
 
-rel createRel(int type, char * value, symbol sym ) {
-	rel r = malloc ( sizeof( *r ) );
+void addRel( segment s, int type, symbol sym, int solved ) {
+	rel r;
 	
-	/* Error Management */
-	if (r == NULL) {
-		ERROR_MSG("Memory error : Malloc failed");
-    }
-    
-    r->section = section;
-    r->addr = addr;
-    r->type = type;
-    r->sym = sym;
-    strcpy( r->value, value);
-    
-	return r;
-}
-
-/**
- * @param
- * @return
- * @brief 
- */
-
-void addRel( chain * r, int type, char * value, symbol sym  ) {
-	/* We add a new element in the chain code */
-	*r = add_chain_next( *r );
+	if ( s->nrel == s->relsize ) {
+		s->rel = arena_realloc( &arenas[ARENA_SYN], s->rel, s->relsize * sizeof( *s->rel ), ( s->relsize ? 2 * s->relsize : 64 ) * sizeof( *s->rel ) );
+		s->relsize = s->relsize ? 2 * s->relsize : 64;
+	}
 	
-	(*r)->this.r = createRel( type, value, sym);
+	r = &s->rel[s->nrel++];
 	
+	r->addr = addr;
+	r->type = type;
+	r->sym = sym;
+	r->solved = solved;
 	
 	return;
 }
-
-/**
- * @param 
- * @return
- * @brief 
- */
-
-rel readRel( chain r ) {
-	if ( r->this.r != NULL ) {
-		return r->this.r;
-	}
-	return NULL;
-}
- 
- 
- 
- 
- 
- 
- 
- 
- 
- 
- 
- 
- 
- 
- 
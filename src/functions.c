@@ -14,449 +14,310 @@
 #include <global.h>
 #include <notify.h>
 #include <functions.h>
-
-
-/* ##### chain functions ##### */
- 
-/**
- * @return The first chain of a collection.
- * @brief Make a collection of chain elements. Each chain contain "chain list of lexemes".
- * Only useful lines are took into account. This means that we remove comments and commas from the list of lexemes.
- * The different kinds of lexemes are indexed in enum in global.h
- *
- */
-chain make_collection( void ) {
-	chain ch = malloc( sizeof( *ch ));
-
-	/* Error Management */
-	if (ch == NULL) {
-		ERROR_MSG("Memory error : Malloc failed.");
-    }
-
-	/* Init */
-	ch->line = 0;
-	ch->next = NULL;
-	ch->this.bottom = NULL;
-
-	return ch;
-}
- 
-/**
- * @param parent The parent element. 
- * @return The next element of the chain.
- * @brief This is used to create a list of chain elements in order to use it to organize lexemes.
- * For each element we add using this function, we are managing to add a lexeme. (It symbolize a line)
- *
- */
-chain add_chain_next( chain parent ) {
-	chain ch = malloc( sizeof( *ch ));
-
-	/* Error Management */
-	if (ch == NULL) {
-		ERROR_MSG("Memory error : Malloc failed.");
-    }
-    
-
-	/* Init */
-	parent->next = ch;
-	ch->line = line;
-	ch->next = NULL;
-	ch->this.bottom = NULL;
-
-	return ch;
-}
-
-/**
- * @param parent The parent element. 
- * @return The bottom element of the chain.
- * @brief This is used to add a new line to the chain.
- *
- */
- 
-chain add_chain_bottom( chain parent ) {
-	chain ch = malloc( sizeof( *ch ));
-
-	/* Error Management */
-	if (ch == NULL) {
-		ERROR_MSG("Memory error : Malloc failed.");
-    }
-    
-
-	/* Init */
-
-	parent->this.bottom = ch;
-	ch->line = line;
-	ch->next = NULL;
-	ch->this.bottom = NULL;
-
-	return ch;
-}
-
-
-
-
+#include <atom.h>
+#include <arena.h>
+#include <regtrie.h>
+#include <literal.h>
 
 
 /* ##### LEX functions ##### */
 
 /**
- * @return A digit pointer.
- * @brief Simple function to make a digit.
- *
- */
-
-digit make_digit( void ) {
-	digit dig = malloc( sizeof( *dig ) );
-	
-	/* Error Management */
-	if (dig == NULL) {
-		ERROR_MSG("Memory error : Malloc failed.");
-    }
-    
-	return dig;
-}
-
-/**
- * @param octalNumber From atoi function
- * @return The converted octal number
- * @brief This function convert an octal number to an int. An octal written as int type is smaller than an int.
- * No Segfault will occur.
- *
- */
-
-int OctalToDecimal(int octalNumber)
-{
-    int decimalNumber = 0, i = 0;
-
-    while(octalNumber != 0)
-    {
-        decimalNumber += (octalNumber%10) << (3*i);
-        ++i;
-        octalNumber/=10;
-    }
-
-    i = 1;
-
-    return decimalNumber;
-}
-
- 
-/**
- * @param type Explicit type of lexeme.
- * @return The lex structure ( a pointer !)
- * @brief Useful to create fastly a lexeme of a kind of type. All the type are explicited in global.h by enum.
- * If there is an immediate value, it will be directly evaluated.
+ * @param l The lexeme to fill, for example an entry of the token buffer.
+ * @param type Explicit type of lexeme. All the type are explicited in global.h by enum.
+ * @param value The token, NUL terminated.
+ * @param sign SIGNED if the token starts with '-'.
+ * @return nothing
+ * @brief Useful to fill fastly a lexeme of a kind of type. If there is an immediate value, it will be directly evaluated.
+ * Otherwise, the name is interned.
  *
  */
 
-lex make_lex( unsigned int type, char * value, int sign ) {
-	lex l = malloc( sizeof( *l ) );
-	
-	/* Error Management */
-	if (l == NULL) {
-		ERROR_MSG("Memory error : Malloc failed.");
-    }
-    
+void fill_lex( lex l, unsigned int type, char * value, int sign ) {
+	
+	int t;
+	
 	l->type = type;
 	
-	if (sign == SIGNED) { /* We eat '-', but not mandatory because strtol manages '-' in fact */
+	if (sign == SIGNED) { /* We eat '-' */
 		value++;
 	}
 	
-	
-	digit dig = make_digit();
-
 	switch (type) {
 		case DECIMAL_ZERO:
-			dig->type = DECIMAL_ZERO;
-			dig->sign = sign;
-			dig->this.integer = 0;
-			
-			dig->value = 0;
-			
-			l->this.digit = dig;
-			
-			break; 
-			
 		case BIT:
-			dig->type = BIT;
-			dig->sign = sign;
-			dig->this.integer = binaryToInt( value );
-			
-			if( sign == SIGNED )
-				dig->value = ~ dig->this.integer + 1; /* NOT(a) + 1 // Complement of 2 */
-			else dig->value = dig->this.integer;
-			
-			l->this.digit = dig;
-			
-			break; 
-			
 		case DECIMAL:
-			dig->type = DECIMAL;
-			dig->sign = sign;
-			dig->this.integer = atoi( value );
-			
-			if( sign == SIGNED )
-				dig->value = ~ dig->this.integer + 1; /* NOT(a) + 1 // Complement of 2 */
-			else dig->value = dig->this.integer;
-			
-			l->this.digit = dig;
-			
-			break;  
-				  			
 		case OCTO:
-			dig->type = OCTO;
-			dig->sign = sign;
-			dig->this.octo = atoi( value );
-			
-			if( sign == SIGNED )
-				dig->value = ~ OctalToDecimal(dig->this.integer) + 1; /* NOT(a) + 1 // Complement of 2 */
-			else dig->value = OctalToDecimal(dig->this.integer);
-			
-			l->this.digit = dig;
-			
-			break; 
-				  			
 		case HEXA:
-			dig->type = HEXA;
-			dig->sign = sign;
-			dig->this.hexa = value;
-			
-			if( sign == SIGNED )
-				dig->value = ~ (int)strtol(value, NULL, 0) + 1; /* NOT(a) + 1 // Complement of 2 */
-			else dig->value = (int)strtol(value, NULL, 0);
-			
-			l->this.digit = dig;
-			
-			break;
+			/* Converted and checked in one pass by the reader of its base, see literal.c */
+			literal_read( l, type, value, sign );
+			return;
 			
 		case REGISTER:
-			dig->type = REGISTER;
-			dig->sign = sign;
-			
-			dig->value = registerToInt(value);
-			
-			
-			l->this.digit = dig;
-			
-			break;
+			if ( (t = registerToInt( value, strlen( value ) )) < 0 ) {
+				ERROR_MSG("Lexical error : %s is not a register", value);
+			}
+			l->this.value = t;
+			return;
 				 			
 		default :
-			strncpy ( l->this.value, value, sizeof(l->this.value) );
-			break;
+			l->this.atom = atom_intern( value, strlen( value ) );
+			return;
 	}
-	
-	
-	return l;
 }
 
+/* ##### Token buffer functions ##### */
+
 /**
- * @param chain Chain to link.
- * @param lex Lexeme to add.
- * @return Nothing
- * @brief Add a lexeme to the bottom of a chain element.
+ * @param size Number of tokens to reserve. The buffer grows if needed.
+ * @return An empty token buffer.
+ * @brief Make the token buffer filled by the lexer. Tokens and lines are stored in arrays, not in chains :
+ * lexing n tokens only needs a few allocations. The buffer lives in the lexing arena.
  *
  */
- 
-void add_lex( chain parent, lex l ) {
-	parent->this.bottom_lex = l;
+
+tokens make_tokens( unsigned int size ) {
+	tokens t = arena_alloc( &arenas[ARENA_LEX], sizeof( *t ) );
+	
+	t->count = 0;
+	t->size = 0;
+	t->type = NULL;
+	t->lexeme = NULL;
+	t->line = NULL;
 	
-	return;
+	t->nlines = 0;
+	t->lsize = 0;
+	t->lines = NULL;
+	
+	t->scratch = FALSE;
+	
+	reserve_tokens( t, size > 0 ? size : 1 );
+	
+	return t;
 }
 
 /**
- * @return unsigned int to be construct to build the decode code.
- * @brief this routine convert a char of a specified register to his int equivalent.
+ * @param t The token buffer.
+ * @param size Number of tokens the buffer must be able to hold.
+ * @return nothing
+ * @brief Grow the columns of the token buffer.
  *
  */
 
-unsigned int registerToInt( char *input ) {
-	
-	unsigned int t = 0;
+void reserve_tokens( tokens t, unsigned int size ) {
 	
-	if ( input[0] == '$' ) {
-		if ( !strcmp( input+1, "zero" ) ) {
-			t = 0;
-		}
-		else if ( !strcmp( input+1, "at" ) ) {
-			t = 1;
-		}
-		else if ( !strcmp( input+1, "gp" ) ) {
-			t = 28;
-		}
-		else if ( !strcmp( input+1, "sp" ) ) {
-			t = 29;
-		}
-		else if ( !strcmp( input+1, "fp" ) ) {
-			t = 30;
-		}
-		else if ( !strcmp( input+1, "ra" ) ) {
-			t = 31;
-		}
-		else {
-			switch (input[1]) {
-				case 'v':
-					t = atoi(input+2) + 2;
-				break;
-	
-				case 'a':
-					t = atoi(input+2) + 4;
-				break;
-	
-				case 't':
-					if (atoi(input+2) < 8) t = atoi(input+2) + 8;
-					else t = atoi(input+2) + 16;
-			
-				break;
+	if ( size <= t->size ) {
+		return;
+	}
 	
-				case 's':
-					t = atoi(input+2) + 16;
-				break;
+	t->type = arena_realloc( &arenas[ARENA_LEX], t->type, t->size * sizeof( *t->type ), size * sizeof( *t->type ) );
+	t->lexeme = arena_realloc( &arenas[ARENA_LEX], t->lexeme, t->size * sizeof( *t->lexeme ), size * sizeof( *t->lexeme ) );
+	t->line = arena_realloc( &arenas[ARENA_LEX], t->line, t->size * sizeof( *t->line ), size * sizeof( *t->line ) );
 	
-				case 'k':
-					t = atoi(input+2) + 16;
-				break;
+	t->size = size;
+}
+
+/**
+ * @param t The token buffer.
+ * @param size Number of lines the line table must be able to hold.
+ * @return nothing
+ * @brief Grow the line table of the token buffer.
+ *
+ */
+
+void reserve_lines( tokens t, unsigned int size ) {
 	
-				default:
-					t = atoi( input+1);
-				break;
-			}
-		}
-		
-	}
-	else {
-		t = binaryToInt( input );
+	if ( size <= t->lsize ) {
+		return;
 	}
 	
+	t->lines = arena_realloc( &arenas[ARENA_LEX], t->lines, t->lsize * sizeof( *t->lines ), size * sizeof( *t->lines ) );
+	t->lsize = size;
+}
+
+/**
+ * @param t The token buffer.
+ * @param type Type of the lexeme.
+ * @return The lexeme of the new token, to be filled with fill_lex.
+ * @brief Add a token to the line being lexed. The line is added to the line table by add_token_line once complete.
+ *
+ */
+
+lex add_token( tokens t, unsigned int type ) {
 	
-	if (t > 31) {
-		ERROR_MSG("Decode error : one register is badly written. Please check source code or instSet.txt");
+	if ( t->count == t->size ) {
+		reserve_tokens( t, 2 * t->size );
 	}
 	
-	return t;
+	t->type[t->count] = type;
+	t->line[t->count] = t->nlines;
 	
+	return &t->lexeme[t->count++];
 }
 
 /**
- * @param s The binary string to analyse
- * @return an unsigned int as a result
- * @brief Convert a binary string to an unsigned integer
+ * @param t The token buffer.
+ * @param line Line number in the source code.
+ * @param first First token of the line.
+ * @return nothing
+ * @brief Close a line : the tokens added since first are recorded in the line table, if any.
  *
  */
 
-
-unsigned int binaryToInt( char* start ) {
-	unsigned int total = 0;
+void add_token_line( tokens t, unsigned int line, unsigned int first ) {
+	
+	if ( t->count == first ) {
+		return;
+	}
 	
-	while (*start)
-	{
-		total <<= 1;
-   		if (*start++ == '1') total^=1;
+	if ( t->nlines == t->lsize ) {
+		t->lines = arena_realloc( &arenas[ARENA_LEX], t->lines, t->lsize * sizeof( *t->lines ), ( t->lsize ? 2 * t->lsize : 64 ) * sizeof( *t->lines ) );
+		t->lsize = t->lsize ? 2 * t->lsize : 64;
 	}
 	
-	return total;
+	t->lines[t->nlines].line = line;
+	t->lines[t->nlines].first = first;
+	t->lines[t->nlines].count = t->count - first;
+	t->nlines++;
 }
 
-
-
-/* ##### Chain management functions ##### */
+/* ##### Symbol table functions ##### */
 
 /**
- * @param chain to print.
- * @return the lexeme contained in the chain element, if any error, returns NULL.
- * @brief Is use to read the lexeme contained in a chain element.
+ * @return An empty symbol table.
+ * @brief Make the symbol table. It lives in the decoding arena.
  *
  */
- 
-lex read_lex( chain parent ) {
+
+symtab make_symtab( void ) {
+	symtab st = arena_alloc( &arenas[ARENA_SYN], sizeof( *st ) );
 	
-	/* We start by verifying if we are in the case of a lexeme : */
-	if ( parent->this.bottom_lex != NULL ) {
-		return parent->this.bottom_lex;
-	}
+	st->sym = NULL;
+	st->count = 0;
+	st->size = 0;
 	
-	return NULL ;
-
+	st->slots = NULL;
+	st->nslots = 0;
+	
+	return st;
 }
 
+/* ##### Segment functions ##### */
+
 /**
- * @param chain Chain to read.
- * @return Give next chain to read. Returns NULL if the chain is completed.
- * @brief Read trough a given chain line. Each time it used, it gives the next chain in the same line.
+ * @param section TEXT, DATA, BSS, or UNDEFINED for the code written before any section directive.
+ * @return An empty segment.
+ * @brief Make the code buffer of a section. It lives in the decoding arena.
  *
  */
- 
-chain read_next( chain parent ) {
+
+segment make_segment( int section ) {
+	segment s = arena_alloc( &arenas[ARENA_SYN], sizeof( *s ) );
 	
-	if( parent->next != NULL ) {
-		return parent->next;
-	}
+	s->section = section;
+	s->data = NULL;
+	s->base = 0;
+	s->size = 0;
+	s->capacity = 0;
+	
+	s->out = NULL;
+	s->rels = NULL;
 	
-	return NULL ;
+	s->rows = NULL;
+	s->nrows = 0;
+	s->rsize = 0;
 	
+	s->rel = NULL;
+	s->nrel = 0;
+	s->relsize = 0;
+	
+	return s;
 }
 
 /**
- * @param chain Chain to read.
- * @return Give next line to read. Returns NULL if the chain is completed OR if the chain is connected to a lexeme intead of another chain.
- * @brief Keep in mind the structure, with this function, you can load the next line.
+ * @param s The segment.
+ * @param size Size the segment must reach.
+ * @return nothing
+ * @brief Grow a segment, the new bytes are zeros. The bytes of .bss are never stored, nor the ones below base.
  *
  */
- 
-chain read_bottom( chain parent ) {
+
+void reserve_segment( segment s, unsigned int size ) {
+	unsigned int capacity;
+	
+	if ( size <= s->size ) {
+		return;
+	}
 	
-	if( parent->this.bottom != NULL ) {
-		return parent->this.bottom;
+	if ( s->section != BSS && size - s->base > s->capacity ) {
+		capacity = s->capacity ? 2 * s->capacity : 1024;
+		
+		while ( capacity < size - s->base ) {
+			capacity = 2 * capacity;
+		}
+		
+		s->data = arena_realloc( &arenas[ARENA_SYN], s->data, s->capacity, capacity );
+		s->capacity = capacity;
 	}
 	
-	return NULL ;
+	if ( s->section != BSS ) {
+		memset( s->data + s->size - s->base, 0, size - s->size );
+	}
 	
+	s->size = size;
 }
 
 /**
- * @return An int
- * @brief Hash function used to generate a number knowing a string.
+ * @param s The segment.
+ * @param type WORD, BYTE or SPACE.
+ * @param size Number of bytes.
+ * @return nothing
+ * @brief Record that the current line emits size bytes at the current address, for the listing.
+ * Consecutive words of the same line share a row.
  *
  */
-int hash( char * s, int modulo ) {
-	int i =0;
-	int result = 0;
+
+void add_segment_row( segment s, int type, unsigned int size ) {
+	struct row_t * last = s->nrows ? &s->rows[s->nrows-1] : NULL;
 	
-	while ( s[i] != '\0' ) {
-		result = result + ( s[i] << i);
-		i++;
+	if ( type == WORD && last != NULL && last->type == WORD && last->line == line && last->addr + last->size == addr ) {
+		last->size += size;
+		return;
 	}
 	
-	return result % modulo;
+	if ( s->nrows == s->rsize ) {
+		s->rows = arena_realloc( &arenas[ARENA_SYN], s->rows, s->rsize * sizeof( *s->rows ), ( s->rsize ? 2 * s->rsize : 64 ) * sizeof( *s->rows ) );
+		s->rsize = s->rsize ? 2 * s->rsize : 64;
+	}
+	
+	s->rows[s->nrows].line = line;
+	s->rows[s->nrows].addr = addr;
+	s->rows[s->nrows].size = size;
+	s->rows[s->nrows].type = type;
+	s->nrows++;
 }
 
 /**
- * @return A string with upper chars
- * @brief Is used to recognize some symbols. Example : addi -> ADDI. Took from openclassroom forum.
+ * @param name Register name, with its '$'. Not necessarily NUL terminated.
+ * @param len Length of the name.
+ * @return The register number, with REGISTER_FP for the coprocessor registers ($f0-$f31). -1 if the name is not a register.
+ * @brief Convert a register name to its number : the numbers ($0-$31) and the ABI names ($zero, $t0 ...) of registers.txt.
+ * The name is read in the register trie (see regtrie.h), one table access per character.
  *
  */
 
-void majuscule(char *chaine)
-{
-    int i = 0;
-    for (i = 0 ; chaine[i] != '\0' ; i++)
-    {
-        chaine[i] = toupper(chaine[i]);
-    }
+int registerToInt( const char * name, size_t len ) {
+	
+	unsigned int state = REG_ROOT;
+	size_t i;
+	
+	if ( len < 2 || name[0] != '$' ) {
+		return -1;
+	}
+	
+	for ( i = 1; i < len; i++ ) {
+		state = reg_next[state][reg_class[(unsigned char) name[i]]];
+	}
+	
+	return reg_value[state];
 }
-
-
- 
- 
- 
- 
- 
- 
- 
- 
- 
- 
- 
- 
- 
-
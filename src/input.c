@@ -0,0 +1,165 @@
+/**
+ * @file input.c
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief Source file loading.
+ *
+ * The source file is memory-mapped in one piece. When it can not be mapped (pipe, character device ...),
+ * it is read into a single growing buffer instead. The lexer and the listing then read lines as spans
+ * (start, length) into this buffer : no line is copied and there is no limit on the length of a line.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include <global.h>
+#include <notify.h>
+#include <input.h>
+
+
+/**
+ * @param fd File descriptor to read until the end.
+ * @param in Input to fill.
+ * @return nothing
+ * @brief Fallback when mmap is not possible : read the whole stream into one buffer, doubling its size when full.
+ */
+
+static void input_read( int fd, input in ) {
+	size_t capacity = 1 << 16;
+	ssize_t n;
+
+	in->data = malloc( capacity );
+	in->size = 0;
+
+	if ( in->data == NULL ) {
+		ERROR_MSG("Memory error : Malloc failed.");
+	}
+
+	while ( (n = read( fd, in->data + in->size, capacity - in->size )) != 0 ) {
+
+		if ( n < 0 ) {
+			ERROR_MSG("Error while reading %s --- Aborts", in->name);
+		}
+
+		in->size += n;
+
+		if ( in->size == capacity ) {
+			capacity *= 2;
+			in->data = realloc( in->data, capacity );
+
+			if ( in->data == NULL ) {
+				ERROR_MSG("Memory error : Realloc failed.");
+			}
+		}
+	}
+
+	in->mapped = FALSE;
+}
+
+/**
+ * @param file Assembly source code file name.
+ * @return The loaded input.
+ * @brief Load the whole source file in memory. Regular files are mapped, anything else is read.
+ */
+
+input input_open( char * file ) {
+	struct stat st;
+	int fd;
+	input in = malloc( sizeof( *in ) );
+
+	/* Error Management */
+	if (in == NULL) {
+		ERROR_MSG("Memory error : Malloc failed.");
+	}
+
+	fd = open( file, O_RDONLY );
+
+	if ( fd < 0 ) {
+		ERROR_MSG("Error while trying to open %s file --- Aborts",file);
+	}
+
+	in->name = file;
+	in->data = NULL;
+	in->size = 0;
+	in->mapped = FALSE;
+
+	if ( fstat( fd, &st ) == 0 && S_ISREG( st.st_mode ) ) {
+
+		/* An empty file can not be mapped, there is nothing to read anyway */
+		if ( st.st_size > 0 ) {
+			in->data = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+			if ( in->data != MAP_FAILED ) {
+				in->size = st.st_size;
+				in->mapped = TRUE;
+			}
+			else {
+				in->data = NULL;
+				input_read( fd, in );
+			}
+		}
+	}
+	else {
+		input_read( fd, in );
+	}
+
+	close( fd );
+
+	return in;
+}
+
+/**
+ * @param in Loaded input.
+ * @param pos Offset where the line starts. Updated to the start of the following line.
+ * @param start Set to the first character of the line.
+ * @param len Set to the length of the line, final '\n' excluded.
+ * @return TRUE if a line has been read, FALSE at the end of the input.
+ * @brief Read the next line of the input as a span into the buffer.
+ */
+
+int input_line( input in, size_t * pos, char ** start, size_t * len ) {
+	char * end;
+
+	if ( *pos >= in->size ) {
+		return FALSE;
+	}
+
+	*start = in->data + *pos;
+	end = memchr( *start, '\n', in->size - *pos );
+
+	if ( end == NULL ) {
+		/* Last line without final '\n' */
+		*len = in->size - *pos;
+		*pos = in->size;
+	}
+	else {
+		*len = end - *start;
+		*pos = *pos + *len + 1;
+	}
+
+	return TRUE;
+}
+
+/**
+ * @param in Input to release.
+ * @return nothing
+ * @brief Unmap or free the buffer of the input.
+ */
+
+void input_close( input in ) {
+
+	if ( in->mapped ) {
+		munmap( in->data, in->size );
+	}
+	else {
+		free( in->data );
+	}
+
+	free( in );
+}
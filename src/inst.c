@@ -1,155 +1,203 @@
-
 /**
  * @file inst.c
  * @author François Portet <francois.portet@imag.fr>
  * @brief Instructions routines.
  *
+ * The instruction set is not read at startup : tools/genisa compiles instSet.txt into the binary
+ * (isahash.c), or into a table file that is mapped as is.
  */
- 
+
+#define _POSIX_C_SOURCE 200112L
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
-#include <ctype.h>
-#include <strings.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 
 #include <global.h>
 #include <notify.h>
 #include <inst.h>
-#include <functions.h>
+#include <isahash.h>
 
 
+/* Upper case of an ASCII letter, other characters are kept */
+#define FOLD( c )  ( ( (c) >= 'a' && (c) <= 'z' ) ? (c) - 'a' + 'A' : (c) )
 
 /**
- * @return A tab of the desired instruction set.
- * @brief A table with all instruction set information is loaded. The structure of this information is described in "inst" type definition.
- *
+ * @param set The instruction set.
+ * @param s Mnemonic, not necessarily NUL terminated. Case does not matter.
+ * @param len Length of the mnemonic.
+ * @return The slot of the mnemonic, -1 if it is not in the set.
+ * @brief One hash and one compare : FNV-1a of the upper case name, moved by the displacement of its
+ * bucket (see tools/genisa.c, which must compute the same).
+ */
+
+static int isa_find( isa set, const char * s, size_t len ) {
+	unsigned int h = 2166136261U;
+	const char * name;
+	size_t i;
+	int k;
+
+	if ( len >= sizeof( set->set->name ) ) {
+		return -1;
+	}
+
+	for ( i = 0; i < len; i++ ) {
+		h = ( h ^ (unsigned char) FOLD( s[i] ) ) * 16777619U;
+	}
+
+	h = ( h ^ set->disp[h % set->nbuckets] * 0x9E3779B9U ) * 0x85EBCA6BU;
+	k = ( h >> 16 ) % set->nkeys;
+	name = set->set[k].name;
+
+	for ( i = 0; i < len && FOLD( name[i] ) == FOLD( s[i] ); i++ );
+
+	return ( i == len && name[len] == '\0' ) ? k : -1;
+}
+
+/**
+ * @param file Table file written by "genisa -b".
+ * @return The instruction set of the file.
+ * @brief The file is mapped and used in place, after checking that it has been written by this build.
  */
 
-void instructionSet( inst * tab ) {
-	
-	/* File init */
-	FILE *fp   = NULL;
-    char * file = NULL;
-	
-	/* We load the file which contain all the instruction set, you can rename it here if you want ! */
-	
-	file  	= "instSet.txt";
-
-
-    if ( NULL == file ) {
-        ERROR_MSG("Error, no intruction set file specified in source code !");
-
-    }
-    
-    fp = fopen( file, "r" );
-    
-    if ( NULL == fp ) {
-        ERROR_MSG("Error while trying to open %s file --- Aborts",file);
-    }
-    
-    /* File opened, the structure is like this : "SRL 000010 0 0111 rs=00001". For more information, please read the documentation. */
-    
-    /* General struture : OP BinaryDecode Type(R=0,I=1,J=2) Operand SpecialSet */
-    
-    /* Init */
-    int i=0, j=0;
-    char line[STRLEN];
-    char *seps = " ";
-    char *token = NULL;
-    
-    /* Used to save the tokenized strings */
-    char* result[5];
-    
-    
-    while(!feof(fp)) {
-    
-    	/*read line-by-line */
-    	
-    	/* In case there are no special arguments */
-    	result[4]=NULL;
-    
-        if ( NULL != fgets( line, STRLEN-1, fp ) ) {
-        	line[strlen(line)-1] = '\0';  /* eat final '\n' */
-            
-            if ( 0 != strlen(line) ) {
-            	for( token = strtok( line, seps ); NULL != token; token = strtok( NULL, seps )) {
-            		result[i] = token;
-            		i++;
-            	}
-            }
-            
-            /* Add instruction to the table */
-            
-            j = hash( result[0], 1000);
-            
-            if ( tab[j] != NULL ) {
-            	ERROR_MSG("There is a collision, hash function have to be changed");
-            }
-            else {
-            	/* Make instruction and record it */
-            	tab[j]= makeInst( result[0], result[1], result[2], result[3], result[4]);
-            } 
-            
-            
-            i=0;
-        }
-		
-	
+static isa mapInstructionSet( char * file ) {
+	isa set = malloc( sizeof( *set ) );
+	struct isa_file_t * header;
+	struct stat st;
+	unsigned int i, n;
+	int fd, k;
+
+	/* Error Management */
+	if ( set == NULL ) {
+		ERROR_MSG("Memory error : Malloc failed.");
+	}
+
+	fd = open( file, O_RDONLY );
+
+	if ( fd < 0 ) {
+		ERROR_MSG("Error while trying to open %s file --- Aborts",file);
+	}
+
+	if ( fstat( fd, &st ) != 0 || (size_t) st.st_size < sizeof( *header ) ) {
+		ERROR_MSG("Error : %s is not an instruction set table", file);
+	}
+
+	set->size = st.st_size;
+	set->map = mmap( NULL, set->size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	close( fd );
+
+	if ( set->map == MAP_FAILED ) {
+		ERROR_MSG("Error while trying to map %s file --- Aborts",file);
+	}
+
+	header = set->map;
+
+	if ( memcmp( header->magic, ISA_MAGIC, sizeof( header->magic ) ) || header->entry != sizeof( struct inst_t ) ) {
+		ERROR_MSG("Error : %s is not an instruction set table of this version, run \"genisa -b\" again", file);
+	}
+
+	set->nkeys = header->nkeys;
+	set->nbuckets = header->nbuckets;
+	set->ninst = header->ninst;
+
+	if ( set->nkeys == 0 || set->nbuckets == 0 || set->ninst < set->nkeys || set->ninst > set->size / header->entry
+		|| set->size != sizeof( *header ) + set->ninst * sizeof( struct inst_t ) + set->nbuckets * sizeof( *set->disp ) ) {
+		ERROR_MSG("Error : the table of %s is truncated", file);
+	}
+
+	set->set = (inst) ( header + 1 );
+	set->disp = (const unsigned short *) ( set->set + set->ninst );
+
+	/* The lookup trusts the names and the links, the encoder the number of special operands */
+	for ( i = 0; i < set->ninst; i++ ) {
+		if ( memchr( set->set[i].name, '\0', sizeof( set->set[i].name ) ) == NULL
+			|| set->set[i].nspecials < -1 || set->set[i].nspecials > INST_SPECIALS
+			|| set->set[i].next < -1 || set->set[i].next >= (int) set->ninst
+			|| set->set[i].alt < -1 || set->set[i].alt >= (int) set->ninst ) {
+			ERROR_MSG("Error : instruction %u of %s is corrupted", i, file);
+		}
+	}
+
+	/* The decoder expands a pseudo-instruction in a buffer of INST_EXPANSION instructions : no chain may be longer, or loop */
+	for ( i = 0; i < set->ninst; i++ ) {
+
+		for ( n = 1, k = set->set[i].next; k >= 0 && n <= INST_EXPANSION; n++, k = set->set[k].next );
+
+		if ( n > INST_EXPANSION ) {
+			ERROR_MSG("Error : the expansion of instruction %u of %s is too long", i, file);
+		}
 	}
-	
-	/* The last one is NULL (to treat with loop) */
-	
-	tab[j] = NULL;
-	
+
+	return set;
+}
+
+/**
+ * @param file Table file written by "genisa -b", NULL for the set compiled in as-mips.
+ * @return The instruction set.
+ * @brief Nothing is parsed : the built-in set is static data, a table file is mapped.
+ */
+
+isa instructionSet( char * file ) {
+	isa set = ( file == NULL ) ? &isa_builtin : mapInstructionSet( file );
+	inst ins;
+	unsigned int i;
+
 	/* ---- TEST 3 ---- */
-	
+
 	if (testID == 3) {
-    
-		i=0;
-		while ( i<1000 ) {
-			if (tab[i] != NULL) {
-				WARNING_MSG("%s | %s key %d", tab[i]->name, tab[i]->opcode, i );
+
+		for ( i = 0; i < set->nkeys; i++ ) {
+			for ( ins = &set->set[i]; ins != NULL; ins = ( ins->alt < 0 ) ? NULL : &set->set[ins->alt] ) {
+				WARNING_MSG("%s | %s key %d", ins->name, ins->opcode, i );
 			}
-		
-			i++;
 		}
 	}
-	
-	
+
+	return set;
 }
 
 /**
- * @param name Name of instruction, "ADD"
- * @param op Binary translation, "10000"
- * @param type From enum (see header) R => 0, ...
- * @param operand Define which operands are defined. For example, 0110 => Only rt and rd can be defined in assembly source code. 
- * @param special Define automatically some operands. For example, sa=00000 in case of ADD.
- * @return A completed structure Inst, ready to be added to the instruction set chain.
- * @brief Routine to make fastly a instruction using string parameters.
- *
+ * @param set Instruction set given by instructionSet().
+ * @return nothing
+ * @brief Unmap a table file. The built-in set is kept.
  */
 
+void closeInstructionSet( isa set ) {
 
-inst makeInst( char* name, char* op, char* type, char* operand, char* special ) {
-	inst ins = malloc( sizeof( *ins ) );
-
-	/* strncpy copy the string arguments in the structure, you can't do that with a simple "=" ! */
-	strncpy ( ins->name, name, sizeof(ins->name) );
-	strncpy ( ins->opcode, op, sizeof(ins->opcode) );
-	ins->op = binaryToInt( op );
-	
-	ins->type = atoi( type );
-	strncpy ( ins->operand, operand, sizeof(ins->operand) );
-	
-	if (special != NULL && special[0] != '#') {
-		strcpy ( ins->special, special );
+	if ( set->map != NULL ) {
+		munmap( set->map, set->size );
+		free( set );
 	}
-	else {
-		strcpy ( ins->special, "#" );
-	}
-	
-	
-	return ins;
 }
 
+/**
+ * @param set The instruction set.
+ * @param name Mnemonic as written in the source, not necessarily NUL terminated.
+ * @param len Length of the mnemonic.
+ * @return The number of the instruction in set->set, -1 if the mnemonic is unknown.
+ * @brief Mnemonics are not case sensitive, unless the set has several spellings of a name : then
+ * the exact spelling is taken, and the upper case one by default. Example : Lw is the pseudo
+ * instruction, lw and LW the real one. The name is read in place, it is not changed.
+ */
+
+int findInstId( isa set, const char * name, size_t len ) {
+	int j = isa_find( set, name, len );
+	int k;
 
+	if ( j < 0 ) {
+		return -1;
+	}
+
+	for ( k = set->set[j].alt; k >= 0; k = set->set[k].alt ) {
+
+		if ( !strncmp( set->set[k].name, name, len ) && set->set[k].name[len] == '\0' ) {
+			return k;
+		}
+	}
+
+	return j;
+}
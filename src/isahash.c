@@ -0,0 +1,55 @@
+/**
+ * @file isahash.c
+ * @brief Built-in instruction set and its perfect hash.
+ *
+ * Generated by tools/genisa from instSet.txt. Do not edit : change the spec and run "make tables".
+ */
+
+#include <global.h>
+#include <isahash.h>
+
+/* Displacement of each bucket */
+static const unsigned short disp[30] = {
+	    6,    0,    1,    0,    5,    0,    1,    1,
+	    2,    9,    1,    1,    1,    0,    0,    0,
+	    2,    0,    0,    1,    5,    0,    8,    0,
+	    8,    0,    2,    3,    0,    0
+};
+
+/* Instruction of each slot, then the other spellings :
+   name, opcode, type, operand mask, register mask, special operands (-1 : none), next instruction, next spelling */
+static const struct inst_t set[31] = {
+	{ "LUI", "001111", 15, 1, 0x6, 0x2, -1, { { 0 } }, -1, -1 },
+	{ "NEG", "100010", 34, 0, 0x3, 0x3, -1, { { 0 } }, -1, -1 },
+	{ "AND", "100100", 36, 0, 0x7, 0x7, -1, { { 0 } }, -1, -1 },
+	{ "J", "000010", 2, 2, 0x1, 0x0, -1, { { 0 } }, -1, -1 },
+	{ "NOP", "000000", 0, 0, 0x0, 0x0, -1, { { 0 } }, -1, -1 },
+	{ "XOR", "100110", 38, 0, 0x7, 0x7, -1, { { 0 } }, -1, -1 },
+	{ "ADD", "100000", 32, 0, 0x7, 0x7, -1, { { 0 } }, -1, -1 },
+	{ "MFLO", "010010", 18, 0, 0x4, 0x4, -1, { { 0 } }, -1, -1 },
+	{ "SUB", "100010", 34, 0, 0x7, 0x7, -1, { { 0 } }, -1, -1 },
+	{ "BEQ", "000100", 4, 4, 0x7, 0x3, -1, { { 0 } }, -1, -1 },
+	{ "LI", "001000", 8, 1, 0x6, 0x2, -1, { { 0 } }, -1, -1 },
+	{ "JR", "001000", 8, 0, 0x1, 0x1, -1, { { 0 } }, -1, -1 },
+	{ "LW", "100011", 35, 3, 0x7, 0x3, -1, { { 0 } }, -1, 30 },
+	{ "DIV", "011010", 26, 0, 0x3, 0x3, -1, { { 0 } }, -1, -1 },
+	{ "MOVE", "100000", 32, 0, 0x3, 0x3, -1, { { 0 } }, -1, -1 },
+	{ "BLEZ", "000110", 6, 1, 0x5, 0x1, -1, { { 0 } }, -1, -1 },
+	{ "SRL", "000010", 2, 0, 0xE, 0x6, -1, { { 0 } }, -1, -1 },
+	{ "SLL", "000000", 0, 0, 0xE, 0x6, -1, { { 0 } }, -1, -1 },
+	{ "OR", "100101", 37, 0, 0x7, 0x7, -1, { { 0 } }, -1, -1 },
+	{ "SW", "101011", 43, 3, 0x7, 0x3, -1, { { 0 } }, -1, -1 },
+	{ "BGTZ", "000111", 7, 1, 0x5, 0x1, -1, { { 0 } }, -1, -1 },
+	{ "BNE", "000101", 5, 4, 0x7, 0x3, -1, { { 0 } }, -1, -1 },
+	{ "SLT", "101010", 42, 0, 0x7, 0x7, -1, { { 0 } }, -1, -1 },
+	{ "ROTR", "000010", 2, 0, 0xE, 0x6, 4, { { 0 }, { -1, { REGISTER, 1, UNSIGNED, { 1 } } }, { 1 }, { 2 } }, -1, -1 },
+	{ "Lw*", "100011", 35, 3, 0x7, 0x3, 3, { { 0 }, { 1 }, { -1, { REGISTER, 1, UNSIGNED, { 1 } } } }, -1, -1 },
+	{ "MFHI", "010000", 16, 0, 0x4, 0x4, -1, { { 0 } }, -1, -1 },
+	{ "JAL", "000011", 3, 2, 0x1, 0x0, -1, { { 0 } }, -1, -1 },
+	{ "SYSCALL", "001100", 12, 0, 0x0, 0x0, -1, { { 0 } }, -1, -1 },
+	{ "ADDI", "001000", 8, 1, 0x7, 0x3, -1, { { 0 } }, -1, -1 },
+	{ "MULT", "011000", 24, 0, 0x3, 0x3, -1, { { 0 } }, -1, -1 },
+	{ "Lw", "001111", 15, 1, 0x6, 0x2, 2, { { -1, { REGISTER, 1, UNSIGNED, { 1 } } }, { 1 } }, 24, -1 }
+};
+
+struct isa_t isa_builtin = { 30, 30, disp, 31, set, NULL, 0 };
@@ -1,4 +1,3 @@
-
 /**
  * @file lex.c
  * @author François Portet <francois.portet@imag.fr>
@@ -17,356 +16,505 @@
 #include <global.h>
 #include <notify.h>
 #include <lex.h>
+#include <lexfsm.h>
+#include <scan.h>
+#include <input.h>
 #include <functions.h>
+#include <atom.h>
+#include <inst.h>
+#include <arena.h>
+#include <pool.h>
+
+/* Fewest bytes of source worth a thread of its own */
+#define LEX_CHUNK  65536
+
+/*!
+  \brief A chunk of whole lines, lexed by a thread of its own.
+ */
+
+struct lex_chunk_t {
+	char * start;
+	char * end;
+	isa set;
+	
+	/* Lexed by the thread, in its own arena : tokens, number of lines, texts of its atoms */
+	tokens t;
+	unsigned int nlines;
+	unsigned int natoms;
+	char ** text;
+	unsigned int * len;
+	struct arena_t arena;
+	
+	/* Atom of the source for each atom of the chunk, then where its tokens, lines and line numbers go */
+	unsigned int * map;
+	unsigned int first;
+	unsigned int nline;
+	unsigned int line0;
+};
+
+/*!
+  \brief The chunks of a source, and the token buffer they are copied in.
+ */
+
+struct lex_chunks_t {
+	tokens t;
+	struct lex_chunk_t chunk[POOL_MAX];
+};
 
 /**
- * @param line String of the line of source code to be analysed.
- * @param nline the line number in the source code.
- * @return should return the collection of lexemes that represent the input line of source code.
- * @brief This function performs lexical analysis of one standardized line.
+ * @param token The token, NUL terminated. The final ':' of a label is eaten in place.
+ * @param len Length of the token.
+ * @param final Final state of the FSM for this token.
+ * @param t Token buffer that receives the lexeme.
+ * @param first First token of the line.
+ * @param set Instruction set.
+ * @return nothing
+ * @brief Use the final state of the FSM to determine the lexeme and add it to the line.
+ * Numbers and registers are evaluated, names are interned. The first symbol of a statement, after its labels,
+ * is looked up in the instruction set : if it is a mnemonic, the lexeme is the number of its instruction.
  *
  */
- 
-void lex_read_line( char *sline, int nline, chain newline) {
 
-	int i;
-	int sign;
-	
-	/* We first use newline as an initial affectation */
-	chain element = add_chain_next( newline );
+static void lex_emit( char * token, size_t len, int final, tokens t, unsigned int first, isa set ) {
 
+	int state = lex_accept[final];
+	int sign = ( token[0] == '-' ) ? SIGNED : UNSIGNED;
+	int id;
+	lex l;
+	
+	/* A label ends with ':', we eat it */
+	if ( state == LABEL ) {
+		token[--len] = '\0';
+	}
 	
-	/* Useful when a token is defined as a comment, all the following tokens are also undertood as comments */
-	int comment = 0;
+	if (testID == 1) {
+		WARNING_MSG("[%s] %s", state_to_string(state), token);
+	}
+	
+	/* /!\ If there is any error, we raise it and stop the program /!\ */
 	
-	/* After standarizing, we only need ' ' as sep */
-    char *seps = " ";
-    char *token = NULL;
-    char save[STRLEN];
+	if ( state == ERROR ) {
+		ERROR_MSG("Lexical error. One of lexemes failed. Example : Be sure that you are not writing an hexa without 0x");
+	}
+	
+	/* /!\ Punctuations and comments are not added to the collection (skip if) /!\ */
+	
+	if ( !( state == COMMENT || state == PUNCTUATION || state == INIT ) ) {
+		/* The name of the instruction is not interned : the decoder only needs its number */
+		if ( state == SYMBOL && ( t->count == first || t->type[t->count - 1] == LABEL )
+			&& (id = findInstId( set, token, len )) >= 0 ) {
+			
+			l = add_token( t, MNEMONIC );
+			l->type = MNEMONIC;
+			l->this.id = id;
+		}
+		else {
+			/* Add the token and evaluate its value in place */
+			fill_lex( add_token( t, state ), state, token, sign );
+		}
+	}
+	
+	return;
+}
 
-    /* copy the input line so that we can do anything with it without impacting outside world*/
-    memcpy( save, sline, STRLEN );
-    
+/**
+ * @param token Scratch buffer of the current token.
+ * @param size Size of the scratch buffer.
+ * @param n Number of characters the buffer must be able to hold, final '\0' excluded.
+ * @return nothing
+ * @brief Make the token scratch buffer big enough. A token has no length limit.
+ *
+ */
 
-    /* get each token */
-    for( token = strtok( save, seps ); NULL != token; token = strtok( NULL, seps )) {
-    	
- 		/* Re-initialisation of FSM */
-    	int state = INIT;
-    	sign = UNSIGNED;
-    	
-        for ( i= 0; i< strlen(token); i++ ) {
-        	
-        	switch (state) {
-        		case INIT :
-        			if ( token[i] == '-' ) {
-        				sign = SIGNED;
-        			}
-        			else if ( token[i] == '#' || comment) {
-        				comment = 1;
-        				state = COMMENT;
-        			}
-        			else if ( token[i] == '0' ) {
-        				state = DECIMAL_ZERO;
-        			}
-        			else if ( isdigit(token[i]) ) {
-        				state = DECIMAL;
-        			}
-        			else if ( token[i] == '.' ) {
-        				state = DIRECTIVE;
-        			}
-        			else if ( token[i] == '$' ) {
-        				state = REGISTER;
-        			}
-        			else if ( token[i] == ',' || token[i] == '(' || token[i] == ')' ) {
-        				state = PUNCTUATION;
-        			}
-        			else {
-        				state = SYMBOL;
-        			}
-        			
-        			
-        			
-        			break;
-        		
-        		case DECIMAL_ZERO :
-    				if ( token[i] < '8' && token[i] >= '0' ) {
-    					state = OCTO;
-    				}
-    				else if ( token[i] == 'x' ) {
-    					state = HEXA;
-    				}
-    				else if ( token[i] == '8' || token[i] == '9' ) {
-    					state = DECIMAL;
-    				}
-    				else if ( token[i] == 'b' ) {
-    					state = BIT;
-    				}
-    				else {
-    					/* In all other cases, there is an error. */
-    					state = ERROR;
-    				}
-        			
-        			break;
-        			
-        		case BIT :
-					state = ( token[i] == '1' || token[i] == '0'  ) ? BIT : ERROR;
-					break; 
-        		
-        		case DECIMAL :
-					state = ( isdigit( token[i] ) ) ? DECIMAL : ERROR;
-					break;  
-					      			
-        		case OCTO:
-        			state = ( isdigit( token[i] ) && token[i] < '8' ) ? OCTO : ERROR;
-					
-					break; 
-					      			
-        		case HEXA:
-        			state = ( isxdigit( token[i] ) ) ? HEXA : ERROR;
-					
-					break;
-					
-				
-				/* All other states are managed by default : We do nothing ! */			
-        		default :
-					
-					break;
-        			
-        		
-        	
-        	
-        	}
-        	
-        	
-        }
-        
-        /* verifying if the last character is ":" */
-        if ( token[strlen(token)-1] == ':' && state == SYMBOL) {
-        	state = LABEL;
-        	
-        	/* We eat ':' */
-        	token[strlen(token)-1] = '\0';
-        }
-        
-        
-        
-        /* We use the final value of state to determine the lexeme 
-        DEBUG_MSG("[%s] %s", state_to_string(state), token); */
-        
-		/* /!\ If there is any error, we raise it and stop the program /!\ */
+static void lex_reserve( char ** token, size_t * size, size_t n ) {
+	
+	if ( n + 1 > *size ) {
+		*size = 2 * (n + 1);
+		*token = realloc( *token, *size );
+		
+		if ( *token == NULL ) {
+			ERROR_MSG("Memory error : Realloc failed.");
+		}
+	}
+}
+
+/**
+ * @param p The opening quote.
+ * @param end End of the source buffer.
+ * @param t Token buffer that receives the string.
+ * @param token Scratch buffer used to build the string, grown if needed.
+ * @param size Size of the scratch buffer.
+ * @return The character after the closing quote.
+ * @brief Read a string literal. Escapes (\n, \t, \0, \\, \", \') are replaced by the byte they stand for,
+ * and the string is interned : the lexeme holds the atom of its bytes, quotes excluded. The strings of a
+ * buffer which only holds one line at a time are scratch atoms : they are not kept.
+ *
+ */
+
+static char * lex_string( char * p, char * end, tokens t, char ** token, size_t * size ) {
+
+	size_t n = 0;
+	char c;
+	lex l;
+	
+	for ( p++; p < end && *p != '"' && *p != '\n'; p++ ) {
+		c = *p;
 		
-		if ( state == ERROR ) {
-			ERROR_MSG("Lexical error. One of lexemes failed. Example : Be sure that you are not writing an hexa without 0x");
+		if ( c == '\\' && p + 1 < end && p[1] != '\n' ) {
+			switch ( *++p ) {
+				case 'n' : c = '\n'; break;
+				case 't' : c = '\t'; break;
+				case '0' : c = '\0'; break;
+				default  : c = *p; break;
+			}
 		}
-        
-        /* /!\ Punctuations and comments are not added to the collection (skip if) /!\ */
-        
-        if ( !( state == COMMENT || state == PUNCTUATION || state == INIT ) ) {
-			/* Create lexeme and add value */
-			lex lexeme = make_lex( state, token, sign );
 		
-			/* Add lexeme to the element */
-			add_lex(element, lexeme);
+		lex_reserve( token, size, n + 1 );
+		(*token)[n++] = c;
+	}
+	
+	if ( p == end || *p != '"' ) {
+		ERROR_MSG("Lexical error. A string is not closed by a '\"' before the end of the line");
+	}
+	
+	if (testID == 1) {
+		WARNING_MSG("[%s] %.*s", state_to_string(STRING), (int) n, *token);
+	}
+	
+	l = add_token( t, STRING );
+	l->type = STRING;
+	l->this.atom = t->scratch ? atom_scratch( *token, n ) : atom_intern( *token, n );
+	
+	return p + 1;
+}
+
+/**
+ * @param sline Start of the line of source code to be analysed (possibly very badly written), not NUL terminated.
+ * @param end End of the source buffer.
+ * @param nline the line number in the source code.
+ * @param t Token buffer. The tokens of the line are added at its end, and the line to its line table.
+ * @param token Scratch buffer used to build the current token, grown if needed.
+ * @param size Size of the scratch buffer.
+ * @param set Instruction set, which gives the mnemonics.
+ * @return The start of the next line.
+ * @brief This function performs lexical analysis of one line in a single pass.
+ * Each character is classified once with the class map of the FSM (see lexFSM.txt) : it either separates
+ * tokens or is appended to the current token and makes the FSM take one transition. A token is only completed
+ * when the next one starts, because ':' always sticks to the previous token, even after blanks ("EXIT :" is the label EXIT).
+ * - blanks separate tokens,
+ * - ',', '(', ')' are tokens on their own and are not added to the collection,
+ * - '#' starts a comment : the rest of the line is ignored,
+ * - '-' starts a new token and eats the following blanks ("- 43" is -43),
+ * - '"' starts a string, read up to the closing quote by lex_string.
+ * Runs that can not change the token are skipped in bulk with the scan functions (see scan.h) :
+ * blanks, comments and the inside of symbols, registers and directives.
+ *
+ */
+ 
+char * lex_read_line( char *sline, char *end, int nline, tokens t, char **token, size_t *size, isa set ) {
+
+	size_t n = 0;        /* length of the current token, 0 if none */
+	size_t run;
+	int sep = FALSE;     /* TRUE if the next character must start a new token */
+	int state = STATE_INIT;
+	int class;
+	unsigned int first = t->count;
+	
+	while ( sline < end ) {
+		
+		class = lex_class[(unsigned char) *sline];
+		
+		if ( class == CLASS_NEWLINE ) {
+			sline++;
+			break;
+		}
+		
+		if ( class == CLASS_BLANK ) {
+			sep = TRUE;
+			sline += scan_blank( sline, end - sline );
+			continue;
+		}
 		
-			/* TEST Code
-			if (read_lex(element) != NULL ) {
-				WARNING_MSG("%s", state_to_string( read_lex(element)->type ) );
-			}*/
+		/* ':' is always appended to the current token, any other character may start a new one */
+		if ( n > 0 && class != CLASS_COLON && ( sep || class == CLASS_PUNCT || class == CLASS_HASH || class == CLASS_MINUS || class == CLASS_QUOTE ) ) {
+			(*token)[n] = '\0';
+			lex_emit( *token, n, state, t, first, set );
 			
+			/* Re-initialisation of FSM */
+			n = 0;
+			state = STATE_INIT;
+		}
 		
-			/* Create a new chain element to store the next lexeme */
-			element = add_chain_next( element );
+		/* All the following tokens are comments : we jump to the end of the line */
+		if ( class == CLASS_HASH ) {
+			sline += scan_newline( sline, end - sline );
+			continue;
 		}
-        
-    }
-    
+		
+		if ( class == CLASS_QUOTE ) {
+			sline = lex_string( sline, end, t, token, size );
+			sep = TRUE;
+			continue;
+		}
+		
+		lex_reserve( token, size, n + 1 );
+		(*token)[n++] = *sline++;
+		state = lex_next[state][class];
+		
+		switch (class) {
+			case CLASS_PUNCT :
+			case CLASS_COLON :
+				sep = TRUE;
+				break;
+			
+			case CLASS_MINUS :
+				/* If the characters after are blank, we eat them : the number is stuck to '-' */
+				sline += scan_blank( sline, end - sline );
+				sep = FALSE;
+				break;
+				
+			default :
+				sep = FALSE;
+				
+				/* The state will not change before the next separator : we copy the whole run */
+				if ( lex_loop[state] ) {
+					run = scan_separator( sline, end - sline );
+					lex_reserve( token, size, n + run );
+					memcpy( *token + n, sline, run );
+					n += run;
+					sline += run;
+				}
+				break;
+		}
+	}
 	
-    return;
+	if ( n > 0 ) {
+		(*token)[n] = '\0';
+		lex_emit( *token, n, state, t, first, set );
+	}
+	
+	add_token_line( t, nline, first );
+	
+    return sline;
+}
+
+/**
+ * @param context The chunks.
+ * @param k The chunk to lex.
+ * @return nothing
+ * @brief Lex the lines of a chunk, numbered from 1, on a new thread : its tokens and its atoms are in the arena of the thread,
+ * which is kept in the chunk.
+ *
+ */
+
+static void lex_chunk( void * context, unsigned int k ) {
+	struct lex_chunk_t * c = &( (struct lex_chunks_t *) context )->chunk[k];
+	char * p = c->start;
+	char * token = NULL;
+	size_t size = 0;
+	unsigned int a;
+	
+	c->t = make_tokens( ( c->end - c->start ) / 8 + 1 );
+	c->nlines = 0;
+	
+	while ( p < c->end ) {
+		c->nlines++;
+		
+		if ( *p != '\n' ) {
+			p = lex_read_line( p, c->end, c->nlines, c->t, &token, &size, c->set );
+		}
+		else {
+			p++;
+		}
+	}
+	
+	free( token );
+	
+	c->natoms = atom_count();
+	c->text = arena_alloc( &arenas[ARENA_LEX], ( c->natoms + 1 ) * sizeof( *c->text ) );
+	c->len = arena_alloc( &arenas[ARENA_LEX], ( c->natoms + 1 ) * sizeof( *c->len ) );
+	
+	for ( a = 1; a <= c->natoms; a++ ) {
+		c->text[a] = atom_text( a );
+		c->len[a] = atom_length( a );
+	}
+	
+	c->arena = arenas[ARENA_LEX];
 }
 
 /**
- * @param file Assembly source code file name.
+ * @param context The chunks, with their atoms mapped.
+ * @param k The chunk to copy.
+ * @return nothing
+ * @brief Copy the tokens and the lines of a chunk in the token buffer of the source.
+ *
+ */
+
+static void lex_stitch( void * context, unsigned int k ) {
+	struct lex_chunk_t * c = &( (struct lex_chunks_t *) context )->chunk[k];
+	tokens t = ( (struct lex_chunks_t *) context )->t;
+	unsigned int i;
+	
+	for ( i = 0; i < c->t->count; i++ ) {
+		t->type[c->first + i] = c->t->type[i];
+		t->lexeme[c->first + i] = c->t->lexeme[i];
+		t->line[c->first + i] = c->t->line[i] + c->line0;
+		
+		/* Numbers, registers and mnemonics have no atom */
+		switch ( c->t->type[i] ) {
+			case DECIMAL_ZERO :
+			case BIT :
+			case DECIMAL :
+			case OCTO :
+			case HEXA :
+			case REGISTER :
+			case MNEMONIC :
+				break;
+			
+			default :
+				t->lexeme[c->first + i].this.atom = c->map[c->t->lexeme[i].this.atom];
+				break;
+		}
+	}
+	
+	for ( i = 0; i < c->t->nlines; i++ ) {
+		t->lines[c->line0 + i].line = c->t->lines[i].line + c->nline;
+		t->lines[c->line0 + i].first = c->t->lines[i].first + c->first;
+		t->lines[c->line0 + i].count = c->t->lines[i].count;
+	}
+}
+
+/**
+ * @param in Assembly source code loaded in memory.
  * @param nlines Pointer to the number of lines in the file.
- * @return should return the collection of lexemes
- * @brief This function loads an assembly code from a file into memory.
+ * @param t Token buffer filled with the lexemes of the whole file.
+ * @param set Instruction set, which gives the mnemonics.
+ * @param threads Number of threads.
+ * @return nothing
+ * @brief Lex a big source on several threads. The source is cut in chunks of whole lines, each one lexed on a thread
+ * of its own. The atoms of each chunk are interned again in order, chunk after chunk : an atom is given at the first
+ * use of its name in the source, as if the source were lexed by one thread. Then the chunks are copied in the token
+ * buffer, their line numbers and atoms corrected.
  *
  */
-void lex_load_file( char *file, unsigned int *nlines, chain ch ) {
 
-    FILE        *fp   = NULL;
-    char         fline[STRLEN]; /* original source line */
-    char         res[2*STRLEN]; /* standardised source line, can be longeur due to some possible added spaces*/
+static void lex_load_chunks( input in, unsigned int *nlines, tokens t, isa set, unsigned int threads ) {
+	
+	struct lex_chunks_t chunks;
+	struct lex_chunk_t * c = chunks.chunk;
+	unsigned int n, k, a, count = 0, lines = 0;
+	size_t step = in->size / threads;
+	char * p = in->data;
+	char * end = in->data + in->size;
+	
+	for ( n = 0; n < threads && p < end; n++ ) {
+		c[n].start = p;
+		c[n].set = set;
+		
+		/* The chunk ends after a newline */
+		p = ( n + 1 < threads && (size_t) ( end - p ) > step ) ? p + step : end;
+		
+		while ( p < end && p[-1] != '\n' ) {
+			p++;
+		}
+		
+		c[n].end = p;
+	}
+	
+	pool_each( n, lex_chunk, &chunks );
+	
+	*nlines = 0;
+	
+	for ( k = 0; k < n; k++ ) {
+		c[k].map = arena_alloc( &arenas[ARENA_LEX], ( c[k].natoms + 1 ) * sizeof( *c[k].map ) );
+		c[k].map[NO_ATOM] = NO_ATOM;
+		
+		for ( a = 1; a <= c[k].natoms; a++ ) {
+			c[k].map[a] = atom_intern( c[k].text[a], c[k].len[a] );
+		}
+		
+		c[k].first = t->count + count;
+		c[k].line0 = t->nlines + lines;
+		c[k].nline = *nlines;
+		
+		count += c[k].t->count;
+		lines += c[k].t->nlines;
+		*nlines += c[k].nlines;
+	}
+	
+	reserve_tokens( t, t->count + count );
+	reserve_lines( t, t->nlines + lines );
+	
+	chunks.t = t;
+	pool_run( threads, n, lex_stitch, &chunks );
+	
+	t->count += count;
+	t->nlines += lines;
+	line += *nlines;
+	
+	for ( k = 0; k < n; k++ ) {
+		arena_free( &c[k].arena );
+	}
+}
 
+/**
+ * @param in Assembly source code loaded in memory.
+ * @param nlines Pointer to the number of lines in the file.
+ * @param t Token buffer filled with the lexemes of the whole file.
+ * @param set Instruction set, which gives the mnemonics.
+ * @param threads Number of threads, for a source big enough.
+ * @return nothing
+ * @brief This function reads the source code line by line, directly in the loaded input.
+ *
+ */
+void lex_load_file( input in, unsigned int *nlines, tokens t, isa set, unsigned int threads ) {
 
+    char        *p     = in->data;
+    char        *end   = in->data + in->size;
+    char        *token = NULL; /* current token */
+    size_t       size  = 0;
 
-    fp = fopen( file, "r" );
-    if ( NULL == fp ) {
-        ERROR_MSG("Error while trying to open %s file --- Aborts",file);
+    /* One chunk per thread, none smaller than LEX_CHUNK. The lexemes are dumped in order by one thread */
+    if ( threads > in->size / LEX_CHUNK ) {
+        threads = in->size / LEX_CHUNK;
     }
-
-    *nlines = 0;
     
+    if ( threads > POOL_MAX ) {
+        threads = POOL_MAX;
+    }
     
-    chain newline = ch;
+    if ( threads > 1 && testID != 1 ) {
+        lex_load_chunks( in, nlines, t, set, threads );
+        return;
+    }
 
-    while(!feof(fp)) {
+    *nlines = 0;
+    
+    /* A first guess of the number of tokens, to avoid growing the buffer on usual sources */
+    reserve_tokens( t, in->size / 8 + 1 );
 
-        /*read source code line-by-line */
-        if ( NULL != fgets( fline, STRLEN-1, fp ) ) {
+    while ( p < end ) {
 
-            fline[strlen(fline)-1] = '\0';  /* eat final '\n' */
-            (*nlines)++;
+        (*nlines)++;
 
-            if ( 0 != strlen(fline) ) {
-                lex_standardise( fline, res );
-                lex_read_line( res, *nlines, newline );
-            }
+        if ( *p != '\n' ) {
+            p = lex_read_line( p, end, *nlines, t, &token, &size, set );
+        }
+        else {
+            p++;
         }
-        
-        /* We add a newline in our collection, the condition helps to avoid possible "blank" lines in the collection */
-        
-        if (read_next( newline ) != NULL) {
-    		newline = add_chain_bottom( newline );
-    	}
     	
     	/* Increment line */
 		line++;
     }
     
     
-
-    fclose(fp);
+    free( token );
     return;
 }
 
 
 
-/**
- * @param in Input line of source code (possibly very badly written).
- * @param out Line of source code in a suitable form for further analysis.
- * @return nothing
- * @brief This function will prepare a line of source code for further analysis.
- */
-
-/* Note that MIPS assembly supports distinctions between lower and upper case */
-
-void lex_standardise( char* in, char* out ) {
-
-    unsigned int i = 0, j = 0, k = 0;
-    
-	/* Important note : k means that a space should be added. But the decision is taken by the next char. */
-	
-    while ( i < strlen(in) ) {
-
-        /* translate all spaces (i.e., tab) into simple spaces, we use k to delete futher spaces */
-		
-		if (isblank((int) in[i])) {
-		    k = 1;
-        }
-        else{
-        	switch (in[i]) {
-		    	case ',' :
-		    		
-		    		/* Purpose : Have a space before and after comma in all cases */
-		    		 
-		    		out[j] = ' ';
-		    		out[j+1]=in[i];
-		    		j += 2;
-		    		
-		    		k = 1;
-		    	break;
-		    	
-		    	case '#' :
-		    		
-		    		/* Purpose : Have a space before and after # in all cases (Same as comma !) */
-		    		 
-		    		out[j] = ' ';
-		    		out[j+1]=in[i];
-		    		j += 2;
-		    		
-		    		k = 1;
-		    	break;
-		    	
-		    	case ')' :
-		    		
-		    		/* Purpose : Have a space before and after # in all cases (Same as comma !) */
-		    		 
-		    		out[j] = ' ';
-		    		out[j+1]=in[i];
-		    		j += 2;
-		    		
-		    		k = 1;
-		    	break;
-		    	
-		    	case '(' :
-		    		
-		    		/* Purpose : Have a space before and after # in all cases (Same as comma !) */
-		    		 
-		    		out[j] = ' ';
-		    		out[j+1]=in[i];
-		    		j += 2;
-		    		
-		    		k = 1;
-		    	break;
-		    	
-		    	case ':' :
-		    		
-		    		/* Purpose : Have no space before and only one space after */
-		    		
-		    		out[j]=in[i];
-		    		j++;
-		    		
-		    		k = 1;
-		    	break;
-		    	
-		    	case '-' :
-		    		/* Purpose : Have no space after and only one space before */
-		    		
-		    		out[j] = ' ';
-		    		out[j+1]=in[i];
-		    		j += 2;
-		    		
-		    		/* If the character after is blank, we increment i ! If not, we do nothing. */
-		    		
-		    		while ( isblank((int) in[i+1]) || i+1 == strlen(in) ) {
-		    			i++;
-		    		}
-		    		
-		    		k = 0;
-		    		
-		    	break;
-		    	
-		    	default :
-					if (k) {
-						out[j]=' ';
-						out[j+1]=in[i];
-						j = j + 2;
-						k=0;
-					}
-					else {
-						out[j]=in[i];
-						j++;
-					}
-		    	break;
-        	}
-        }
-        
-        i++;
-		
-    }
-    out[j]='\0';
-
-	/* ---- TEST 1 ---- */
-
-    /* To compare in and out : */
-    
-    if (testID == 1) {
-		WARNING_MSG("In  : %s", in);
-		WARNING_MSG("Out : %s", out);
-    }
-}
-
 /**
  * @param state The state enum (FSM).
  * @return should return a string with the same name as enum case.
@@ -419,6 +567,14 @@ char* state_to_string(int state) {
 			case LABEL:
     			return "LABEL";
 				break; 
+			
+			case STRING:
+    			return "STRING";
+				break; 
+			
+			case MNEMONIC:
+    			return "MNEMONIC";
+				break; 
 				     			
     		default :
     			return "ERROR";
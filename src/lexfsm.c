@@ -0,0 +1,68 @@
+/**
+ * @file lexfsm.c
+ * @brief Lexeme FSM tables.
+ *
+ * Generated by tools/genfsm from lexFSM.txt. Do not edit : change the spec and run "make tables".
+ */
+
+#include <global.h>
+#include <lexfsm.h>
+
+/* Class of each byte */
+const unsigned char lex_class[256] = {
+	 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 0, 0, 0, 0, 0,
+	 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	 1, 0,16, 4,15, 0, 0, 0, 5, 5, 0, 0, 5, 3,14, 0,
+	 7, 8, 9, 9, 9, 9, 9, 9,10,10, 6, 0, 0, 0, 0, 0,
+	 0,13,13,13,13,13,13, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	 0,13,12,13,13,13,13, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	 0, 0, 0, 0, 0, 0, 0, 0,11, 0, 0, 0, 0, 0, 0, 0,
+	 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+/* Next state, indexed by [state][class] */
+const unsigned char lex_next[LEX_STATES][LEX_CLASSES] = {
+	{  6, 6, 6, 0, 9,12, 7, 1, 3, 3, 3, 6, 6, 6,11,10, 8 }, /* INIT */
+	{ 13,13,13,13,13,13,13, 4, 4, 4, 3, 5, 2,13,13,13,13 }, /* DECIMAL_ZERO */
+	{ 13,13,13,13,13,13,13, 2, 2,13,13,13,13,13,13,13,13 }, /* BIT */
+	{ 13,13,13,13,13,13,13, 3, 3, 3, 3,13,13,13,13,13,13 }, /* DECIMAL */
+	{ 13,13,13,13,13,13,13, 4, 4, 4,13,13,13,13,13,13,13 }, /* OCTO */
+	{ 13,13,13,13,13,13,13, 5, 5, 5, 5,13, 5, 5,13,13,13 }, /* HEXA */
+	{  6, 6, 6, 6, 6, 6, 7, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6 }, /* SYMBOL */
+	{  6, 6, 6, 6, 6, 6, 7, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6 }, /* LABEL */
+	{  8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8 }, /* STRING */
+	{  9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9 }, /* COMMENT */
+	{ 10,10,10,10,10,10,10,10,10,10,10,10,10,10,10,10,10 }, /* REGISTER */
+	{ 11,11,11,11,11,11,11,11,11,11,11,11,11,11,11,11,11 }, /* DIRECTIVE */
+	{ 12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12 }, /* PUNCTUATION */
+	{ 13,13,13,13,13,13,13,13,13,13,13,13,13,13,13,13,13 } /* ERROR */
+};
+
+/* Lexeme produced when a token ends in each state */
+const unsigned char lex_accept[LEX_STATES] = { INIT, DECIMAL_ZERO, BIT, DECIMAL, OCTO, HEXA, SYMBOL, LABEL, STRING, COMMENT, REGISTER, DIRECTIVE, PUNCTUATION, ERROR };
+
+/* TRUE if the state loops on every character which is not a separator */
+const unsigned char lex_loop[LEX_STATES] = { FALSE, FALSE, FALSE, FALSE, FALSE, FALSE, TRUE, FALSE, TRUE, TRUE, TRUE, TRUE, TRUE, TRUE };
+
+/* TRUE if the byte is in a separator class */
+const unsigned char lex_separator[256] = {
+	0,0,0,0,0,0,0,0,0,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	1,0,1,1,0,0,0,0,1,1,0,0,1,1,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+};
+
+/* Characters of the separator classes */
+const char lex_separators[] = "\011\012\040\042#(),-:";
@@ -0,0 +1,187 @@
+/**
+ * @file literal.c
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief Numeric literals.
+ *
+ * Each base has its own reader, which converts the digits and detects overflow in the same pass : a
+ * literal is a 32-bit value, written from -2^31 to 2^32-1. The lexeme keeps the number of bits the
+ * value needs, so that a field can be checked without evaluating its operand again.
+ * The lexer (see lexFSM.txt) only gives digits of the right base, after the prefix : 0b, 0, 0x or none.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <global.h>
+#include <notify.h>
+#include <literal.h>
+
+/**
+ * @param s Binary digits, NUL terminated.
+ * @param value Value of the digits.
+ * @return FALSE if the value does not fit in 32 bits.
+ */
+
+static int literal_binary( const char * s, unsigned int * value ) {
+	unsigned int v = 0;
+
+	for ( ; *s; s++ ) {
+
+		if ( v >> 31 ) {
+			return FALSE;
+		}
+
+		v = ( v << 1 ) | ( *s - '0' );
+	}
+
+	*value = v;
+
+	return TRUE;
+}
+
+/**
+ * @param s Octal digits, NUL terminated.
+ * @param value Value of the digits.
+ * @return FALSE if the value does not fit in 32 bits.
+ */
+
+static int literal_octal( const char * s, unsigned int * value ) {
+	unsigned int v = 0;
+
+	for ( ; *s; s++ ) {
+
+		if ( v >> 29 ) {
+			return FALSE;
+		}
+
+		v = ( v << 3 ) | ( *s - '0' );
+	}
+
+	*value = v;
+
+	return TRUE;
+}
+
+/**
+ * @param s Decimal digits, NUL terminated.
+ * @param value Value of the digits.
+ * @return FALSE if the value does not fit in 32 bits.
+ */
+
+static int literal_decimal( const char * s, unsigned int * value ) {
+	unsigned int v = 0;
+	unsigned int d;
+
+	for ( ; *s; s++ ) {
+		d = *s - '0';
+
+		if ( v > ( 0xFFFFFFFFU - d ) / 10 ) {
+			return FALSE;
+		}
+
+		v = v * 10 + d;
+	}
+
+	*value = v;
+
+	return TRUE;
+}
+
+/**
+ * @param s Hexadecimal digits, either case, NUL terminated.
+ * @param value Value of the digits.
+ * @return FALSE if the value does not fit in 32 bits.
+ */
+
+static int literal_hexa( const char * s, unsigned int * value ) {
+	unsigned int v = 0;
+
+	for ( ; *s; s++ ) {
+
+		if ( v >> 28 ) {
+			return FALSE;
+		}
+
+		v = ( v << 4 ) | ( ( *s <= '9' ) ? *s - '0' : ( *s | 0x20 ) - 'a' + 10 );
+	}
+
+	*value = v;
+
+	return TRUE;
+}
+
+/**
+ * @return Number of bits of v, without its leading zeros.
+ */
+
+static unsigned int literal_width( unsigned int v ) {
+	unsigned int bits = 0;
+
+	for ( ; v; v >>= 1 ) {
+		bits++;
+	}
+
+	return bits;
+}
+
+/**
+ * @param l The lexeme to fill.
+ * @param type DECIMAL_ZERO, BIT, DECIMAL, OCTO or HEXA.
+ * @param token The token, prefix included and '-' excluded, NUL terminated.
+ * @param sign SIGNED if the token is written with '-'.
+ * @return nothing
+ * @brief Convert a literal and record its width. Negative values are stored in complement of 2 and
+ * count their sign bit : -32768 needs 16 bits, 32768 and -32769 need 17. Raise an error on overflow.
+ */
+
+void literal_read( lex l, unsigned int type, const char * token, int sign ) {
+	unsigned int magnitude = 0;
+	int ok = TRUE;
+
+	switch ( type ) {
+		case BIT :
+			ok = literal_binary( token + 2, &magnitude );
+			break;
+
+		case OCTO :
+			ok = literal_octal( token + 1, &magnitude );
+			break;
+
+		case DECIMAL :
+			ok = literal_decimal( token, &magnitude );
+			break;
+
+		case HEXA :
+			ok = literal_hexa( token + 2, &magnitude );
+			break;
+
+		default :
+			break;
+	}
+
+	if ( !ok || ( sign == SIGNED && magnitude > 0x80000000U ) ) {
+		ERROR_MSG("Lexical error : %s%s does not fit in 32 bits", ( sign == SIGNED ) ? "-" : "", token);
+	}
+
+	if ( sign == SIGNED && magnitude != 0 ) {
+		l->this.value = 0U - magnitude;
+		l->bits = literal_width( magnitude - 1 ) + 1;
+		l->sign = SIGNED;
+	}
+	else {
+		l->this.value = magnitude;
+		l->bits = literal_width( magnitude );
+		l->sign = UNSIGNED;
+	}
+}
+
+/**
+ * @param l A number lexeme.
+ * @param width Bits of the field.
+ * @param sign SIGNED if the field may hold a negative value, UNSIGNED otherwise.
+ * @return TRUE if the literal fits in the field.
+ */
+
+int literal_fits( lex l, unsigned int width, int sign ) {
+	return l->bits <= width && ( l->sign == UNSIGNED || sign == SIGNED );
+}
@@ -18,19 +18,23 @@
 
 #include <functions.h>
 #include <lex.h>
+#include <input.h>
+#include <scan.h>
 #include <inst.h>
 #include <syn.h>
 #include <eval.h>
 #include <print.h>
+#include <arena.h>
+#include <stream.h>
+#include <parallel.h>
 
 
 
 /* Extern variable definition */
 int testID = 0;
-int section = UNDEFINED;
-unsigned int addr = 0;
-unsigned int line = 1;
-int typeCode = WORD;
+__thread int section = UNDEFINED;
+__thread unsigned int addr = 0;
+__thread unsigned int line = 1;
 
 /**
  * @param exec Name of executable.
@@ -39,7 +43,7 @@ int typeCode = WORD;
  *
  */
 void print_usage( char *exec ) {
-    fprintf(stderr, "Usage: %s [-lbr] [-t #ID] file.s\n",
+    fprintf(stderr, "Usage: %s [-lbrs] [-j threads] [-t #ID] [--isa table.isa] file.s\n",
             exec);
 }
 
@@ -75,8 +79,16 @@ int main ( int argc, char *argv[] ) {
 
     int opt;
     int mode = LIST_MODE;
+    char *isaFile = NULL;
+    unsigned int threads = 1;
     
-	while ((opt = getopt(argc, argv, "lbrt")) != -1) {
+    /* Long options : --isa FILE loads the instruction set from a table file written by "genisa -b" */
+    struct option options[] = {
+    	{ "isa", required_argument, NULL, 'i' },
+    	{ NULL, 0, NULL, 0 }
+    };
+    
+	while ((opt = getopt_long(argc, argv, "lbrst:j:", options, NULL)) != -1) {
         switch (opt) {
         case 'l':
         	if ( argc <3 ) {
@@ -103,6 +115,14 @@ int main ( int argc, char *argv[] ) {
 			
         	mode = ELF_MODE; 
         break;
+        case 's':
+        	if ( argc <3 ) {
+				print_usage(argv[0]);
+				exit( EXIT_FAILURE );
+			}
+			
+        	mode = STREAM_MODE; 
+        break;
         case 't': 
         	if ( argc <4 ) {
 				print_usage(argv[0]);
@@ -110,9 +130,23 @@ int main ( int argc, char *argv[] ) {
 			}
 			
         	mode = TEST_MODE;
-        	testID = atoi(argv[2]);
+        	testID = atoi(optarg);
         	
         break;
+        case 'i':
+        	isaFile = optarg;
+        break;
+        case 'j':
+        	if ( atoi(optarg) < 1 ) {
+				print_usage(argv[0]);
+				exit( EXIT_FAILURE );
+			}
+			
+        	threads = atoi(optarg);
+        break;
+        default:
+        	print_usage(argv[0]);
+        	exit( EXIT_FAILURE );
         
         }
     }
@@ -133,90 +167,87 @@ int main ( int argc, char *argv[] ) {
     
     /* ---------------- init all collections -------------------*/
     
-    /* We create a collection used to contruct the tree of lexemes */ 
-    chain chLex = make_collection();
+    /* The lexemes are stored in a flat token buffer, see global.h */
+    tokens t = make_tokens( 0 );
     
-    /* We make the symTab collection */
-    chain symTab = make_collection();
+    /* We make the symbol table */
+    symtab symTab = make_symtab();
     
-    /* We make the code collection */
-    chain chCode = make_collection();
+    /* The machine code and the relocations are stored in one segment per section, indexed by section */
+    segment seg[SECTIONS] = { make_segment( UNDEFINED ), make_segment( TEXT ), make_segment( DATA ), make_segment( BSS ) };
     
-    /* We make the relocation table collection */
-    chain chRel = make_collection();
     
-    /* We create an array ro reach easily the starting point */
-    chain source[4] = {chLex, symTab, chCode, chRel};
-    chain * c[4] = {&chLex, &symTab, &chCode, &chRel};
     
+    /* ---------------- init instruction set - See inst.h -------------------*/
+    
+    /* The instruction set is compiled in as-mips, unless a table file is given with --isa. The lexer needs it for the mnemonics */
+    isa instSet = instructionSet( isaFile );
+    
+    /* The lexer skips blanks, comments and symbols with the vector instructions of the processor, if any */
+    scan_init( SCAN_BEST );
+    
+    /* ---------------- or assemble in one pass - See stream.h -------------------*/
+    
+    /* The source is read by chunks and the code written as it comes : the memory does not grow with the source */
+    if ( mode == STREAM_MODE ) {
+    	stream( file, instSet, symTab, seg );
+    	print( symTab, seg, mode, 0, NULL );
+    	
+    	arena_free_all();
+    	closeInstructionSet( instSet );
+    	
+    	exit( EXIT_SUCCESS );
+    }
     
     /* ---------------- do the lexical analysis -------------------*/
     
-    lex_load_file( file, &nlines, chLex );
+    /* The source stays loaded until the end : lexemes and listing read it in place */
+    input in = input_open( file );
+    
+    lex_load_file( in, &nlines, t, instSet, threads );
     
     /* ---- TEST 2 ---- */
 
-    /* Dump lexeme chain : */
+    /* Dump the lexemes : */
     
     if (testID == 2) {
     
-		chain chcopy = chLex;
-		chain in;
+		unsigned int i, k;
 		
-		while (  chcopy != NULL ) {
-			in = chcopy;
-			in = read_next( in );
-			
-			if ( in != NULL ) {
-				DEBUG_MSG("Line %d", in->line );
+		for ( i = 0; i < t->nlines; i++ ) {
+			DEBUG_MSG("Line %d", t->lines[i].line );
 			
-				do {
-				
-					if (read_lex( in ) != NULL ) {
-						WARNING_MSG("%s", state_to_string( read_lex(in)->type ) );
-					}
-			
-					in = read_next( in );
-				} while ( in != NULL );
-			
-				DEBUG_MSG("[NL]");
+			for ( k = t->lines[i].first; k < t->lines[i].first + t->lines[i].count; k++ ) {
+				WARNING_MSG("%s", state_to_string( t->type[k] ) );
 			}
 			
-			chcopy = read_bottom( chcopy );
-			
+			DEBUG_MSG("[NL]");
 		}
     }
     
-    /* ---------------- init instruction set - See inst.h -------------------*/
-    
-    /* Generate the instruction set tab */
-	inst instSet[1000] = {NULL};
-    instructionSet(instSet);
-    
     /* ---------------- do the syntactic analysis - See syn.h -------------------*/
     
     
-    /* We fetch each line */
-    while ( chLex != NULL && read_next( chLex ) != NULL ) {
-    	fetch(c, instSet);
-    	
-    	chLex = read_bottom( chLex );
-    	
-    	/* WARNING_MSG("Type => %p", chLex );
-    	
-    	lex l = read_lex( read_next( chLex ));
-    	
-    	WARNING_MSG("Type => %s", state_to_string(l->type)); */
+    /* We fetch each line, or let the threads encode the instructions - See parallel.h */
+    unsigned int i;
+    
+    if ( threads > 1 ) {
+    	parallel_fetch( t, symTab, seg, instSet, threads );
+    }
+    else {
+    	for ( i = 0; i < t->nlines; i++ ) {
+    		fetch( t, t->lines[i].first, t->lines[i].count, symTab, seg, instSet );
+    	}
     }
     
     /* SOLVE relocations section */
-    /* Here we need to use reloc chain and Code chain to solve relocation and delete relative ones */
+    /* Here we need to use the relocations of the segments to solve them and delete relative ones */
     
-    solve( symTab, source[2], source[3] );
+    solve( seg );
 
 
     /* ---------------- print results - See print.h -------------------*/
-    print( source, mode, nlines, file );
+    print( symTab, seg, mode, nlines, in );
     
     
     
@@ -227,7 +258,10 @@ int main ( int argc, char *argv[] ) {
 
     /* ---------------- Free memory and terminate -------------------*/
 
-    /* TODO free everything properly*/
+    /* Tokens, atoms, instruction set, symbols, codes and relocations are all in the arenas */
+    arena_free_all();
+    closeInstructionSet( instSet );
+    input_close( in );
 
     exit( EXIT_SUCCESS );
 }
@@ -0,0 +1,309 @@
+/**
+ * @file parallel.c
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief Decoding on several threads.
+ *
+ * The size of an instruction is known after lexing : 4 bytes per instruction of its expansion. The
+ * statements are decoded in three passes :
+ * - the words of each instruction are counted, by blocks of statements, on all the threads ;
+ * - in order, the labels and the directives are decoded as fetch() does, and each instruction only gets
+ *   its address and its room in its segment : this running sum of the sizes gives the labels their value ;
+ * - the instructions are encoded in place, by blocks, on all the threads.
+ * The symbols used by the instructions are added to the table in the second pass, so that the threads
+ * only read it. Each block has segments of its own, which share the code of the real ones and receive
+ * the relocations of its instructions : they are merged in address order at the end, and the tables
+ * are those of fetch().
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <global.h>
+#include <notify.h>
+#include <functions.h>
+
+#include <parallel.h>
+#include <syn.h>
+#include <eval.h>
+#include <pool.h>
+#include <arena.h>
+
+/* Statements of a block, the job of a thread */
+#define PARALLEL_BLOCK  1024
+
+/*!
+  \brief What the passes share.
+ */
+
+struct parallel_t {
+	tokens t;
+	symtab symTab;
+	isa instSet;
+
+	/* Per statement : words of its instruction, 0 if it has none, then its section and address */
+	unsigned int * words;
+	int * sections;
+	unsigned int * at;
+
+	/* Segments of the blocks, indexed by block * SECTIONS + section */
+	segment * blocks;
+	unsigned int nblocks;
+};
+
+/**
+ * @param t Token buffer.
+ * @param i A statement.
+ * @return The first token of the statement after its labels.
+ */
+
+static unsigned int parallel_skip( tokens t, unsigned int i ) {
+	unsigned int k = t->lines[i].first;
+	unsigned int end = k + t->lines[i].count;
+
+	while ( k < end && t->type[k] == LABEL ) {
+		k++;
+	}
+
+	return k;
+}
+
+/**
+ * @param context What the passes share.
+ * @param block The block of statements.
+ * @return nothing
+ * @brief First pass : the words of the instructions of a block.
+ */
+
+static void parallel_count( void * context, unsigned int block ) {
+	struct parallel_t * p = context;
+	tokens t = p->t;
+	unsigned int i, k, count;
+	unsigned int last = ( block + 1 ) * PARALLEL_BLOCK;
+	inst ins;
+
+	for ( i = block * PARALLEL_BLOCK; i < t->nlines && i < last; i++ ) {
+		k = parallel_skip( t, i );
+		count = 0;
+
+		/* A wrong instruction, or an expansion too long, is reported by decodeInstruction() */
+		if ( k < t->lines[i].first + t->lines[i].count && t->type[k] == MNEMONIC && t->lexeme[k].this.id < p->instSet->ninst ) {
+
+			for ( ins = &p->instSet->set[t->lexeme[k].this.id], count = 1; ins->next >= 0 && count < INST_EXPANSION; count++ ) {
+				ins = &p->instSet->set[ins->next];
+			}
+		}
+
+		p->words[i] = count;
+	}
+}
+
+/**
+ * @param p What the passes share.
+ * @param seg Segments of the sections, indexed by section.
+ * @param room Words of each block in each section, indexed by block * SECTIONS + section, counted here.
+ * @return nothing
+ * @brief Second pass, in order : the statements without instruction are decoded by fetch(), the instructions
+ * get their address and their room in the segment, as if they were encoded.
+ */
+
+static void parallel_layout( struct parallel_t * p, segment * seg, unsigned int * room ) {
+	tokens t = p->t;
+	unsigned int i, k, end, size;
+	segment s;
+
+	for ( i = 0; i < t->nlines; i++ ) {
+		end = t->lines[i].first + t->lines[i].count;
+
+		if ( p->words[i] == 0 ) {
+			fetch( t, t->lines[i].first, t->lines[i].count, p->symTab, seg, p->instSet );
+			continue;
+		}
+
+		line = t->lines[i].line;
+		k = fetchLabels( t, t->lines[i].first, end, p->symTab, seg );
+		s = seg[section];
+
+		if ( s->section == BSS ) {
+			ERROR_MSG("Decode error : only .space can be used in .bss");
+		}
+
+		size = 4 * p->words[i];
+
+		p->sections[i] = section;
+		p->at[i] = addr;
+
+		reserve_segment( s, addr + size );
+		add_segment_row( s, WORD, size );
+		addr = addr + size;
+
+		room[( i / PARALLEL_BLOCK ) * SECTIONS + section] += p->words[i];
+
+		/* The symbols of the operands, as eval() would add them */
+		for ( k++; k < end; k++ ) {
+
+			if ( t->type[k] == SYMBOL && findSymbol( t->lexeme[k].this.atom, p->symTab ) == NULL ) {
+				addSymbol( t->lexeme[k].this.atom, p->symTab, 0 );
+			}
+		}
+	}
+}
+
+/**
+ * @param context What the passes share.
+ * @param block The block of statements.
+ * @return nothing
+ * @brief Third pass : encode the instructions of a block at their address.
+ */
+
+static void parallel_encode( void * context, unsigned int block ) {
+	struct parallel_t * p = context;
+	tokens t = p->t;
+	unsigned int i, k;
+	unsigned int last = ( block + 1 ) * PARALLEL_BLOCK;
+
+	for ( i = block * PARALLEL_BLOCK; i < t->nlines && i < last; i++ ) {
+
+		if ( p->words[i] == 0 ) {
+			continue;
+		}
+
+		section = p->sections[i];
+		addr = p->at[i];
+		line = t->lines[i].line;
+
+		k = parallel_skip( t, i );
+		decodeInstruction( t->lexeme[k].this.id, &t->lexeme[k], t->lines[i].first + t->lines[i].count - k, p->symTab, &p->blocks[block * SECTIONS], p->instSet );
+	}
+}
+
+/**
+ * @param p What the passes share.
+ * @param s Segment of a section.
+ * @return nothing
+ * @brief Merge the relocations of the blocks with the ones of the directives, in address order.
+ */
+
+static void parallel_merge( struct parallel_t * p, segment s ) {
+	unsigned int total = s->nrel;
+	unsigned int b, i, j, n;
+	segment from;
+	rel merged;
+
+	for ( b = 0; b < p->nblocks; b++ ) {
+		total += p->blocks[b * SECTIONS + s->section]->nrel;
+	}
+
+	if ( total == s->nrel ) {
+		return;
+	}
+
+	merged = arena_alloc( &arenas[ARENA_SYN], total * sizeof( *merged ) );
+
+	for ( b = 0, i = 0, n = 0; b < p->nblocks; b++ ) {
+		from = p->blocks[b * SECTIONS + s->section];
+
+		for ( j = 0; j < from->nrel; j++ ) {
+
+			/* The relocations of the directives before */
+			while ( i < s->nrel && s->rel[i].addr < from->rel[j].addr ) {
+				merged[n++] = s->rel[i++];
+			}
+
+			merged[n++] = from->rel[j];
+		}
+	}
+
+	while ( i < s->nrel ) {
+		merged[n++] = s->rel[i++];
+	}
+
+	s->rel = merged;
+	s->nrel = total;
+	s->relsize = total;
+}
+
+/**
+ * @param t Token buffer built by lex.c
+ * @param symTab Symbol table.
+ * @param seg Segments of the sections, indexed by section.
+ * @param instSet Instruction Set.
+ * @param threads Number of threads.
+ * @return nothing
+ * @brief Decode all the statements, as fetch() on each of them would.
+ */
+
+void parallel_fetch( tokens t, symtab symTab, segment * seg, isa instSet, unsigned int threads ) {
+	struct parallel_t p;
+	unsigned int * room;
+	unsigned int b, n;
+	segment s;
+	int k;
+
+	/* The encoding changes the current section, address and line of this thread : they are kept */
+	int current;
+	unsigned int next, last;
+
+	if ( t->nlines == 0 ) {
+		return;
+	}
+
+	p.t = t;
+	p.symTab = symTab;
+	p.instSet = instSet;
+	p.nblocks = ( t->nlines + PARALLEL_BLOCK - 1 ) / PARALLEL_BLOCK;
+
+	p.words = arena_alloc( &arenas[ARENA_SYN], t->nlines * sizeof( *p.words ) );
+	p.sections = arena_alloc( &arenas[ARENA_SYN], t->nlines * sizeof( *p.sections ) );
+	p.at = arena_alloc( &arenas[ARENA_SYN], t->nlines * sizeof( *p.at ) );
+
+	room = arena_alloc( &arenas[ARENA_SYN], p.nblocks * SECTIONS * sizeof( *room ) );
+	memset( room, 0, p.nblocks * SECTIONS * sizeof( *room ) );
+
+	/* /1\ Sizes */
+
+	pool_run( threads, p.nblocks, parallel_count, &p );
+
+	/* /2\ Addresses */
+
+	parallel_layout( &p, seg, room );
+
+	current = section;
+	next = addr;
+	last = line;
+
+	/* The segments of a block share the code, their own relocations and rows can not outgrow their words : one symbol per instruction */
+	p.blocks = arena_alloc( &arenas[ARENA_SYN], p.nblocks * SECTIONS * sizeof( *p.blocks ) );
+
+	for ( b = 0; b < p.nblocks; b++ ) {
+
+		for ( k = 0; k < SECTIONS; k++ ) {
+			n = room[b * SECTIONS + k];
+
+			s = arena_alloc( &arenas[ARENA_SYN], sizeof( *s ) );
+			*s = *seg[k];
+
+			s->rel = n ? arena_alloc( &arenas[ARENA_SYN], n * sizeof( *s->rel ) ) : NULL;
+			s->nrel = 0;
+			s->relsize = n;
+
+			s->rows = n ? arena_alloc( &arenas[ARENA_SYN], n * sizeof( *s->rows ) ) : NULL;
+			s->nrows = 0;
+			s->rsize = n;
+
+			p.blocks[b * SECTIONS + k] = s;
+		}
+	}
+
+	/* /3\ Code */
+
+	pool_run( threads, p.nblocks, parallel_encode, &p );
+
+	for ( k = 0; k < SECTIONS; k++ ) {
+		parallel_merge( &p, seg[k] );
+	}
+
+	section = current;
+	addr = next;
+	line = last;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file pool.c
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief Pool of threads.
+ *
+ * The jobs are small and many : a thread that is done takes the next job not taken yet, so that a
+ * slow job does not leave the other threads idle. The calling thread works too, and the pool is
+ * over when all the jobs are done. A thread that can not be started is not an error : there is
+ * only one thread less.
+ * A job that needs the thread-local data of a new thread is run with pool_each() : one thread per job.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#include <global.h>
+#include <notify.h>
+#include <pool.h>
+
+/*!
+  \brief The jobs of a pool, shared by its threads.
+ */
+
+struct pool_t {
+	pthread_mutex_t lock;
+
+	/* Next job to take, and number of jobs */
+	unsigned int next;
+	unsigned int jobs;
+
+	void ( * work )( void *, unsigned int );
+	void * context;
+};
+
+/**
+ * @param arg The pool.
+ * @return NULL
+ * @brief Take jobs until there is none left.
+ */
+
+static void * pool_worker( void * arg ) {
+	struct pool_t * p = arg;
+	unsigned int job;
+
+	for ( ;; ) {
+		pthread_mutex_lock( &p->lock );
+		job = p->next;
+
+		if ( job < p->jobs ) {
+			p->next++;
+		}
+
+		pthread_mutex_unlock( &p->lock );
+
+		if ( job >= p->jobs ) {
+			return NULL;
+		}
+
+		p->work( p->context, job );
+	}
+}
+
+/**
+ * @param threads Number of threads, the calling one included.
+ * @param jobs Number of jobs.
+ * @param work Does a job : it is given the context and the number of the job.
+ * @param context Data of the jobs.
+ * @return nothing
+ * @brief Run the jobs on the threads, in any order. The jobs must not depend on each other.
+ */
+
+void pool_run( unsigned int threads, unsigned int jobs, void ( * work )( void *, unsigned int ), void * context ) {
+	struct pool_t p;
+	pthread_t id[POOL_MAX];
+	unsigned int started, k;
+
+	p.next = 0;
+	p.jobs = jobs;
+	p.work = work;
+	p.context = context;
+
+	if ( threads > jobs ) {
+		threads = jobs;
+	}
+
+	if ( threads > POOL_MAX ) {
+		threads = POOL_MAX;
+	}
+
+	/* Alone, no need of a lock */
+	if ( threads <= 1 ) {
+		for ( k = 0; k < jobs; k++ ) {
+			work( context, k );
+		}
+
+		return;
+	}
+
+	pthread_mutex_init( &p.lock, NULL );
+
+	for ( started = 0; started < threads - 1; started++ ) {
+
+		if ( pthread_create( &id[started], NULL, pool_worker, &p ) != 0 ) {
+			WARNING_MSG("Pool : only %u threads started", started + 1);
+			break;
+		}
+	}
+
+	pool_worker( &p );
+
+	for ( k = 0; k < started; k++ ) {
+		pthread_join( id[k], NULL );
+	}
+
+	pthread_mutex_destroy( &p.lock );
+}
+
+/*!
+  \brief A job run on a thread of its own.
+ */
+
+struct pool_job_t {
+	void ( * work )( void *, unsigned int );
+	void * context;
+	unsigned int job;
+};
+
+/**
+ * @param arg The job.
+ * @return NULL
+ */
+
+static void * pool_alone( void * arg ) {
+	struct pool_job_t * j = arg;
+
+	j->work( j->context, j->job );
+
+	return NULL;
+}
+
+/**
+ * @param jobs Number of jobs, at most POOL_MAX.
+ * @param work Does a job : it is given the context and the number of the job.
+ * @param context Data of the jobs.
+ * @return nothing
+ * @brief Run each job on a new thread : a job starts with the thread-local data of a new thread,
+ * empty arenas for instance. The calling thread waits.
+ */
+
+void pool_each( unsigned int jobs, void ( * work )( void *, unsigned int ), void * context ) {
+	struct pool_job_t j[POOL_MAX];
+	pthread_t id[POOL_MAX];
+	unsigned int k;
+
+	if ( jobs > POOL_MAX ) {
+		ERROR_MSG("Internal error : %u jobs for a pool of %d threads", jobs, POOL_MAX);
+	}
+
+	for ( k = 0; k < jobs; k++ ) {
+		j[k].work = work;
+		j[k].context = context;
+		j[k].job = k;
+
+		if ( pthread_create( &id[k], NULL, pool_alone, &j[k] ) != 0 ) {
+			ERROR_MSG("Error while trying to start a thread --- Aborts");
+		}
+	}
+
+	for ( k = 0; k < jobs; k++ ) {
+		pthread_join( id[k], NULL );
+	}
+}
@@ -20,153 +20,181 @@
 #include <eval.h>
 #include <syn.h>
 #include <lex.h>
+#include <input.h>
 #include <print.h>
+#include <atom.h>
 
 /**
- * @param c the tab with all inital chain collections pointers.
+ * @param fp Listing file.
+ * @param line Line of the code.
+ * @param s Segment of the code.
+ * @param r Row of the line to address table.
+ * @param source_line Source line printed on the first row, NULL for none.
+ * @param source_len Length of the source line.
+ * @return nothing
+ * @brief Print the code of a row in the listing. Words are printed one per row, a byte run 4 bytes per row
+ * and a space run on a single "0000..." row.
+ */
+
+static void print_row( FILE * fp, unsigned int line, segment s, struct row_t * r, char * source_line, int source_len ) {
+	char hex[9];
+	unsigned int k, j, row;
+	
+	for ( k = 0; k == 0 || k < r->size; k += 4 ) {
+		
+		row = r->addr + k;
+		
+		switch ( r->type ) {
+			case BYTE :
+				for ( j = 0; j < 4 && k + j < r->size; j++ ) {
+					sprintf( hex + 2 * j, "%02X", s->data[row + j - s->base] );
+				}
+				hex[2*j] = '\0';
+			break;
+			
+			case SPACE :
+				strcpy( hex, "0000..." );
+				k = r->size;
+			break;
+			
+			default :
+				sprintf( hex, "%08X", getCode( s, row ) );
+			break;
+		}
+		
+		if ( source_line != NULL ) {
+			fprintf(fp,"%3u %08X %-8s %.*s",line,row,hex,source_len,source_line);
+			source_line = NULL;
+		}
+		else {
+			fprintf(fp,"%3u %08X %-8s %s\n",line,row,hex,"");
+		}
+	}
+}
+
+/**
+ * @param fp Listing file.
+ * @param at Address of the relocation.
+ * @param type Type of the relocation.
+ * @param sym Target symbol.
+ * @return nothing
+ * @brief Print one line of a relocation table.
+ */
+
+void print_reloc( FILE * fp, unsigned int at, int type, symbol sym ) {
+	
+	if (sym->section == NONE )
+		fprintf(fp,"%08x\t%s\t%-4s\t%s\n", at, rel_to_string( type ), section_to_string( sym->section ), atom_text( sym->atom ));
+	else
+		fprintf(fp,"%08x\t%s\t%-4s:%08x\t%s\n", at, rel_to_string( type ), section_to_string( sym->section ), sym->addr, atom_text( sym->atom ));
+}
+
+/**
+ * @param fp Listing file.
+ * @param s Segment of the section.
+ * @return nothing
+ * @brief Print the relocation table of a section.
+ */
+
+static void print_rel( FILE * fp, segment s ) {
+	unsigned int i;
+	
+	for ( i = 0; i < s->nrel; i++ ) {
+		print_reloc( fp, s->rel[i].addr, s->rel[i].type, s->rel[i].sym );
+	}
+}
+
+/**
+ * @param fp Listing file.
+ * @param symTab Symbol table.
+ * @return nothing
+ * @brief Print the symbol table, in order of definition. The symbols of .globl and .extern are GLOBAL.
+ */
+
+static void print_symtab( FILE * fp, symtab symTab ) {
+	symbol sym;
+	symbol * sorted = sortSymbols( symTab );
+	unsigned int k;
+	
+	for ( k = 0; k < symTab->count; k++ ) {
+	
+		sym = sorted[k];
+		
+		if (sym->section == NONE )
+			fprintf(fp,"%3d\t%-4s\t%s", sym->line, section_to_string( sym->section ), atom_text( sym->atom ));
+		else
+			fprintf(fp,"%3d\t%-4s:%08X\t%s", sym->line, section_to_string( sym->section ), sym->addr, atom_text( sym->atom ));
+		
+		fprintf(fp, sym->global ? "\tGLOBAL\n" : "\n");
+	}
+}
+
+/**
+ * @param fp Output file.
+ * @param from Temporary file, read from its start.
+ * @return nothing
+ * @brief Copy a file written in stream mode at the end of the output.
+ */
+
+static void print_copy( FILE * fp, FILE * from ) {
+	char buffer[BUFSIZ];
+	size_t n;
+	
+	rewind( from );
+	
+	while ( (n = fread( buffer, 1, sizeof( buffer ), from )) > 0 ) {
+		fwrite( buffer, 1, n, fp );
+	}
+}
+
+/**
+ * @param symTab Symbol table.
+ * @param seg Segments of the sections, indexed by section.
  * @param mode Output mode
  * @param nline Total lines.
+ * @param in Source code, used to print the listing.
  * @return nothing
- * @brief Using chains, print according to mode.
+ * @brief Using the symbol table and the segments, print according to mode.
  */
  
-void print( chain * c, int mode, int nlines, char* file ) {
+void print( symtab symTab, segment * seg, int mode, int nlines, input in ) {
 	FILE *fp = NULL;
-	FILE *fo = NULL;
-	char source_line[STRLEN];
+	char *source_line;
+	int source_len;
+	size_t pos = 0;
+	size_t len;
 	int i = 1;
-	int j = 3;
-	int k = 0;
-	int n = 2;
-	int intCode = 0;
-	char strPrint[STRLEN] = "";
-	char strNumber[STRLEN];
-	int printed = 0;
+	int printed;
 	
-	/* INIT */
-	symbol sym;
-	chain symTab = c[1];
-	chain chCode = read_next( c[2] );
-	chain chRel = read_next( c[3] );
-	
-	code codes;
+	/* Next row of each segment */
+	unsigned int next[SECTIONS] = {0};
+	int s;
 	
 	switch (mode) {
 		case LIST_MODE :
 			fp = fopen("file.l", "w+");
 			
-			fo = fopen(file, "r");
-			
-			if ( fo == NULL ) {
-				ERROR_MSG("Error while trying to open %s file a second time (Deleted while program is running ?) --- Aborts",file);
-			}
-			
 			/* Print code */
 			for (i=1; i<nlines+1; i++) {
 				
-				if ( NULL != fgets( source_line, STRLEN-1, fo ) ) {
+				if ( input_line( in, &pos, &source_line, &len ) ) {
 					
-					/* We get the first code */
-					codes = getCode( chCode );
+					/* The final '\n' is printed with the line, if there is one */
+					source_len = ( source_line + len < in->data + in->size ) ? len + 1 : len;
 					
-					if ( codes->line == i ) {
-						
-						/* In our project, bss can only be used with directive space */
-						
-						if (codes->section == BSS) {
-							fprintf(fp,"%3u %08X %s %s",i,codes->addr,"0000... ",source_line);
-						
-							/* We read all lines */
-							while ( chCode != NULL && chCode->line == i ) {
-								chCode = read_next(chCode);
-							}
-						}
-						else {
-							
-							
-							if (codes != NULL && codes->type == BYTE) {
-								if ( read_next(chCode) != NULL && read_next(chCode)->line == i ) {
-									intCode = codes->value << (j*2*4);
-									j--;
-								}
-								else {
-									intCode = codes->value;
-								}
-								
-								while ( read_next(chCode) != NULL && read_next(chCode)->line == i ) {
-									chCode = read_next(chCode);
-									codes = getCode( chCode );
-									
-									if ( j >= 0) { /* Branch used to print correctly the code */
-										intCode = intCode + (codes->value << (j*2*4));
-										j--;
-									}
-									else {
-										fprintf(fp,"%3u %08X %08X %s",i,codes->addr-4,intCode,source_line);
-										intCode = codes->value;
-										printed = 1;
-										j=3;
-									}
-								
-								
-									
-								}
-								
-								if ( j > 0 ) {
-									strcat(strPrint, "%3u %08X %0");
-									strNumber[0] = '8' - j * 2 ;
-									strNumber[1] = 'X';
-									k = j;
-									
-									while ( k != 0 ) {
-										strNumber[n] = ' ';
-										k--;
-										n++;
-									}
-									
-									strNumber[n] = '\0' ;
-									strcat(strPrint, strNumber);
-									strcat(strPrint, " %s");
-									
-									if ( printed ) {
-										strcpy(source_line,"\n");
-										printed = 0;
-									}
-									
-									
-									fprintf(fp,strPrint,i,codes->addr,intCode,source_line);
-									
-								}
-								
-								/* Reinit */
-								strPrint[0] = '\0';
-								
-								
-								chCode = read_next(chCode);
-							
-							}
-							else {
-								fprintf(fp,"%3u %08X %08X %s",i,codes->addr,codes->value,source_line);
-						
-								chCode = read_next(chCode);
-						
-								while ( chCode != NULL && chCode->line == i ) {	
-									codes = getCode( chCode );
-									fprintf(fp,"%3u %08X %08X %s\n",i,codes->addr,codes->value,"");
-									chCode = read_next(chCode);
-								}
-							}
-							
-							
-							
-							
-							
-							
+					printed = FALSE;
+					
+					/* The source is printed with the first row of the line */
+					for ( s = 0; s < SECTIONS; s++ ) {
+						while ( next[s] < seg[s]->nrows && seg[s]->rows[next[s]].line == i ) {
+							print_row( fp, i, seg[s], &seg[s]->rows[next[s]++], printed ? NULL : source_line, source_len );
+							printed = TRUE;
 						}
 					}
-					else {
+					
+					if ( !printed ) {
 						/* We only print source_line */
-						fprintf(fp,"%3u %s %s %s",i,"        ","        ",source_line);
+						fprintf(fp,"%3u %s %s %.*s",i,"        ","        ",source_len,source_line);
 					}
 					
 					
@@ -179,18 +207,7 @@ void print( chain * c, int mode, int nlines, char* file ) {
 			
 			/* Print symbol table */
 			fprintf(fp,"\n.symtab\n");
-			while (symTab != NULL) {
-			
-				sym = readSymbol( symTab );
-				
-				if (sym != NULL) {
-					if (sym->section == NONE )
-						fprintf(fp,"%3d\t%-4s\t%s\n", sym->line, section_to_string( sym->section ), sym->value);
-					else
-						fprintf(fp,"%3d\t%-4s:%08X\t%s\n", sym->line, section_to_string( sym->section ), sym->addr, sym->value);
-				}
-				symTab = read_next( symTab );
-			}
+			print_symtab( fp, symTab );
 			
 			
 			
@@ -198,43 +215,10 @@ void print( chain * c, int mode, int nlines, char* file ) {
 			
 			
 			fprintf(fp,"\nrel.text\n");
-			while ( chRel != NULL ) {
-				rel r = readRel( chRel );
-				
-				sym = r->sym;
-				
-				
-				if (r->section == TEXT) {
-					if (sym->section == NONE )
-						fprintf(fp,"%08x\t%s\t%-4s\t%s\n", r->addr, rel_to_string( r->type ), section_to_string( sym->section ), sym->value);
-					else
-						fprintf(fp,"%08x\t%s\t%-4s:%08x\t%s\n", r->addr, rel_to_string( r->type ), section_to_string( sym->section ), sym->addr, sym->value);
-					
-				}
-					
-				
-				chRel = read_next( chRel );
-			}
-			
-			
+			print_rel( fp, seg[TEXT] );
 			
 			fprintf(fp,"\nrel.data\n");
-			chRel = read_next( c[3] );
-			while ( chRel != NULL ) {
-				rel r = readRel( chRel );
-				
-				sym = r->sym;
-				
-				if (r->section == DATA) {
-					if (sym->section == NONE )
-						fprintf(fp,"%08x\t%s\t%-4s\t%s\n", r->addr, rel_to_string( r->type ), section_to_string( sym->section ), sym->value);
-					else
-						fprintf(fp,"%08x\t%s\t%-4s:%08x\t%s\n", r->addr, rel_to_string( r->type ), section_to_string( sym->section ), sym->addr, sym->value);
-					
-				}
-				
-				chRel = read_next( chRel );
-			}
+			print_rel( fp, seg[DATA] );
 			
 			
 			
@@ -254,6 +238,23 @@ void print( chain * c, int mode, int nlines, char* file ) {
 			WARNING_MSG("Test mode END");
 		break;
 		
+		case STREAM_MODE :
+			/* The code is already in file.text and file.data, the relocations in temporary files (see stream.c) */
+			fp = fopen("file.sym", "w+");
+			
+			fprintf(fp,".symtab\n");
+			print_symtab( fp, symTab );
+			
+			fprintf(fp,"\nrel.text\n");
+			print_copy( fp, seg[TEXT]->rels );
+			
+			fprintf(fp,"\nrel.data\n");
+			print_copy( fp, seg[DATA]->rels );
+			
+			fclose(fp);
+			WARNING_MSG("STREAM mode - file.text, file.data and file.sym generated");
+		break;
+		
 		default:
 			fp = fopen("file.o", "w+");
 			
@@ -293,6 +294,10 @@ char* section_to_string(int section) {
     			return ".bss";
 				break;
 			
+			case ABSOLUTE :
+				return "ABS";
+				break;
+			
 			default :
     			return "[UNDEFINED]";
 				break;
@@ -0,0 +1,344 @@
+/**
+ * @file scan.c
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief Bulk scanning of the source buffer.
+ *
+ * Three searches are needed by the lexer :
+ * - the next separator (lex_separators, generated from lexFSM.txt : blanks, newline, '-', '#', ',', '(', ')', ':', '"'),
+ * - the next character which is not blank,
+ * - the next newline, to skip a comment.
+ * They are written three times : one byte at a time, 16 bytes at a time (SSE2) and 32 bytes at a time (AVX2).
+ * scan_init() selects the best version supported by the processor.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <global.h>
+#include <notify.h>
+#include <lexfsm.h>
+#include <scan.h>
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#define SCAN_X86
+#include <immintrin.h>
+#endif
+
+/* Maximum number of separator characters the vector versions compare with */
+#define SCAN_MAX_SEPARATORS  16
+
+/* Most tokens and blank runs are short : the vector versions look at this many bytes one at a time first */
+#define SCAN_SHORT  8
+
+static int nseparators = 0;
+static char separator_list[SCAN_MAX_SEPARATORS];
+
+
+/* ##### Scalar version ##### */
+
+static size_t scan_separator_scalar( const char * p, size_t len ) {
+	size_t i = 0;
+
+	while ( i < len && !lex_separator[(unsigned char) p[i]] ) {
+		i++;
+	}
+
+	return i;
+}
+
+static size_t scan_blank_scalar( const char * p, size_t len ) {
+	size_t i = 0;
+
+	while ( i < len && ( p[i] == ' ' || p[i] == '\t' ) ) {
+		i++;
+	}
+
+	return i;
+}
+
+static size_t scan_newline_scalar( const char * p, size_t len ) {
+	size_t i = 0;
+
+	while ( i < len && p[i] != '\n' ) {
+		i++;
+	}
+
+	return i;
+}
+
+
+#ifdef SCAN_X86
+
+/* Separators broadcast in every byte of a vector, filled by scan_init() */
+static __m128i sep128[SCAN_MAX_SEPARATORS];
+static __m256i sep256[SCAN_MAX_SEPARATORS];
+
+
+/* ##### SSE2 version : 16 bytes at a time ##### */
+
+__attribute__((target("sse2")))
+static void scan_init_sse2( void ) {
+	int k;
+
+	for ( k = 0; k < nseparators; k++ ) {
+		sep128[k] = _mm_set1_epi8( separator_list[k] );
+	}
+}
+
+__attribute__((target("sse2")))
+static size_t scan_separator_sse2( const char * p, size_t len ) {
+	const __m128i * sep = sep128;
+	__m128i block, hit;
+	size_t i;
+	int k, mask;
+
+	i = scan_separator_scalar( p, len < SCAN_SHORT ? len : SCAN_SHORT );
+
+	if ( i < SCAN_SHORT ) {
+		return i;
+	}
+
+	for ( ; i + 16 <= len; i += 16 ) {
+		block = _mm_loadu_si128( (const __m128i *) (p + i) );
+		hit = _mm_cmpeq_epi8( block, sep[0] );
+
+		for ( k = 1; k < nseparators; k++ ) {
+			hit = _mm_or_si128( hit, _mm_cmpeq_epi8( block, sep[k] ) );
+		}
+
+		mask = _mm_movemask_epi8( hit );
+
+		if ( mask ) {
+			return i + __builtin_ctz( mask );
+		}
+	}
+
+	return i + scan_separator_scalar( p + i, len - i );
+}
+
+__attribute__((target("sse2")))
+static size_t scan_blank_sse2( const char * p, size_t len ) {
+	__m128i space = _mm_set1_epi8( ' ' );
+	__m128i tab = _mm_set1_epi8( '\t' );
+	__m128i block;
+	size_t i;
+	int mask;
+
+	i = scan_blank_scalar( p, len < SCAN_SHORT ? len : SCAN_SHORT );
+
+	if ( i < SCAN_SHORT ) {
+		return i;
+	}
+
+	for ( ; i + 16 <= len; i += 16 ) {
+		block = _mm_loadu_si128( (const __m128i *) (p + i) );
+		mask = ~_mm_movemask_epi8( _mm_or_si128( _mm_cmpeq_epi8( block, space ), _mm_cmpeq_epi8( block, tab ) ) ) & 0xFFFF;
+
+		if ( mask ) {
+			return i + __builtin_ctz( mask );
+		}
+	}
+
+	return i + scan_blank_scalar( p + i, len - i );
+}
+
+__attribute__((target("sse2")))
+static size_t scan_newline_sse2( const char * p, size_t len ) {
+	__m128i newline = _mm_set1_epi8( '\n' );
+	size_t i = 0;
+	int mask;
+
+	for ( ; i + 16 <= len; i += 16 ) {
+		mask = _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i *) (p + i) ), newline ) );
+
+		if ( mask ) {
+			return i + __builtin_ctz( mask );
+		}
+	}
+
+	return i + scan_newline_scalar( p + i, len - i );
+}
+
+
+/* ##### AVX2 version : 32 bytes at a time ##### */
+
+__attribute__((target("avx2")))
+static void scan_init_avx2( void ) {
+	int k;
+
+	for ( k = 0; k < nseparators; k++ ) {
+		sep256[k] = _mm256_set1_epi8( separator_list[k] );
+	}
+}
+
+__attribute__((target("avx2")))
+static size_t scan_separator_avx2( const char * p, size_t len ) {
+	const __m256i * sep = sep256;
+	__m256i block, hit;
+	size_t i;
+	int k;
+	unsigned int mask;
+
+	i = scan_separator_scalar( p, len < SCAN_SHORT ? len : SCAN_SHORT );
+
+	if ( i < SCAN_SHORT ) {
+		return i;
+	}
+
+	for ( ; i + 32 <= len; i += 32 ) {
+		block = _mm256_loadu_si256( (const __m256i *) (p + i) );
+		hit = _mm256_cmpeq_epi8( block, sep[0] );
+
+		for ( k = 1; k < nseparators; k++ ) {
+			hit = _mm256_or_si256( hit, _mm256_cmpeq_epi8( block, sep[k] ) );
+		}
+
+		mask = _mm256_movemask_epi8( hit );
+
+		if ( mask ) {
+			return i + __builtin_ctz( mask );
+		}
+	}
+
+	return i + scan_separator_sse2( p + i, len - i );
+}
+
+__attribute__((target("avx2")))
+static size_t scan_blank_avx2( const char * p, size_t len ) {
+	__m256i space = _mm256_set1_epi8( ' ' );
+	__m256i tab = _mm256_set1_epi8( '\t' );
+	__m256i block;
+	size_t i;
+	unsigned int mask;
+
+	i = scan_blank_scalar( p, len < SCAN_SHORT ? len : SCAN_SHORT );
+
+	if ( i < SCAN_SHORT ) {
+		return i;
+	}
+
+	for ( ; i + 32 <= len; i += 32 ) {
+		block = _mm256_loadu_si256( (const __m256i *) (p + i) );
+		mask = ~(unsigned int) _mm256_movemask_epi8( _mm256_or_si256( _mm256_cmpeq_epi8( block, space ), _mm256_cmpeq_epi8( block, tab ) ) );
+
+		if ( mask ) {
+			return i + __builtin_ctz( mask );
+		}
+	}
+
+	return i + scan_blank_sse2( p + i, len - i );
+}
+
+__attribute__((target("avx2")))
+static size_t scan_newline_avx2( const char * p, size_t len ) {
+	__m256i newline = _mm256_set1_epi8( '\n' );
+	size_t i = 0;
+	unsigned int mask;
+
+	for ( ; i + 32 <= len; i += 32 ) {
+		mask = _mm256_movemask_epi8( _mm256_cmpeq_epi8( _mm256_loadu_si256( (const __m256i *) (p + i) ), newline ) );
+
+		if ( mask ) {
+			return i + __builtin_ctz( mask );
+		}
+	}
+
+	return i + scan_newline_sse2( p + i, len - i );
+}
+
+#endif /* SCAN_X86 */
+
+
+size_t (*scan_separator)( const char *, size_t ) = scan_separator_scalar;
+size_t (*scan_blank)( const char *, size_t ) = scan_blank_scalar;
+size_t (*scan_newline)( const char *, size_t ) = scan_newline_scalar;
+
+/**
+ * @param level SCAN_SCALAR, SCAN_SSE2, SCAN_AVX2 or SCAN_BEST for the best one supported by the processor.
+ * @return The level actually selected : a level the processor does not support falls back to a lower one.
+ * @brief Select the implementation of the scan functions. Without any call, the scalar version is used.
+ */
+
+int scan_init( int level ) {
+	const char * c;
+	int best = SCAN_SCALAR;
+
+	if ( nseparators == 0 ) {
+		for ( c = lex_separators; *c != '\0'; c++ ) {
+			if ( nseparators == SCAN_MAX_SEPARATORS ) {
+				ERROR_MSG("Internal error : too many separators in lexFSM.txt for the vector scanner");
+			}
+
+			separator_list[nseparators++] = *c;
+		}
+	}
+
+#ifdef SCAN_X86
+	__builtin_cpu_init();
+
+	if ( __builtin_cpu_supports( "sse2" ) ) {
+		best = SCAN_SSE2;
+	}
+
+	if ( __builtin_cpu_supports( "avx2" ) ) {
+		best = SCAN_AVX2;
+	}
+#endif
+
+	if ( level == SCAN_BEST || level > best ) {
+		level = best;
+	}
+
+	switch ( level ) {
+#ifdef SCAN_X86
+		case SCAN_AVX2 :
+			scan_init_sse2();
+			scan_init_avx2();
+			scan_separator = scan_separator_avx2;
+			scan_blank = scan_blank_avx2;
+			scan_newline = scan_newline_avx2;
+			break;
+
+		case SCAN_SSE2 :
+			scan_init_sse2();
+			scan_separator = scan_separator_sse2;
+			scan_blank = scan_blank_sse2;
+			scan_newline = scan_newline_sse2;
+			break;
+#endif
+
+		default :
+			level = SCAN_SCALAR;
+			scan_separator = scan_separator_scalar;
+			scan_blank = scan_blank_scalar;
+			scan_newline = scan_newline_scalar;
+			break;
+	}
+
+	DEBUG_MSG("Scanner : %s", scan_level_to_string( level ));
+
+	return level;
+}
+
+/**
+ * @param level The scan level.
+ * @return should return a string with the same name as enum case.
+ * @brief This function is useful for debug trace only.
+ */
+
+char * scan_level_to_string( int level ) {
+	switch ( level ) {
+		case SCAN_AVX2 :
+			return "AVX2";
+			break;
+
+		case SCAN_SSE2 :
+			return "SSE2";
+			break;
+
+		default :
+			return "SCALAR";
+			break;
+	}
+}
@@ -0,0 +1,326 @@
+/**
+ * @file stream.c
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief One pass assembly in bounded memory.
+ *
+ * The source is read by chunks and each statement is lexed, decoded and forgotten at once. The code of
+ * .text and .data is written to file.text and file.data as it grows. A reference to a symbol already
+ * defined is solved after its statement. The other ones wait in the fixup chain of their symbol, which is
+ * solved when the symbol is defined : the code is patched in the segment, or in its file if it is already
+ * written. What is kept is the symbol table, the fixups still waiting and a chunk of each section : the
+ * strings of a statement are scratch atoms, forgotten with it.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <global.h>
+#include <notify.h>
+#include <functions.h>
+
+#include <stream.h>
+#include <lex.h>
+#include <syn.h>
+#include <eval.h>
+#include <print.h>
+#include <arena.h>
+#include <atom.h>
+
+/* Bytes read from the source at once, and bytes of a section kept before they are written */
+#define STREAM_CHUNK  65536
+
+/*!
+  \brief A use of a symbol not defined yet : the code at addr in section has to be relocated.
+ */
+
+struct fixup_t {
+	struct fixup_t * next;
+
+	int section;
+	unsigned int addr;
+	int type;
+};
+
+/* Fixups already solved, used again for the next ones */
+static struct fixup_t * spare = NULL;
+
+/**
+ * @param name Name of the file.
+ * @return The file, open to be written and read back.
+ */
+
+static FILE * stream_open( char * name ) {
+	FILE * fp = ( name == NULL ) ? tmpfile() : fopen( name, "w+b" );
+
+	if ( fp == NULL ) {
+		ERROR_MSG("Error while trying to write %s file --- Aborts", name ? name : "a temporary");
+	}
+
+	return fp;
+}
+
+/**
+ * @param s The segment.
+ * @return nothing
+ * @brief Write the bytes of the segment kept in memory. The addresses below the size are now in the file.
+ */
+
+static void stream_flush( segment s ) {
+
+	if ( s->out != NULL && s->size > s->base ) {
+
+		if ( fwrite( s->data, 1, s->size - s->base, s->out ) != s->size - s->base ) {
+			ERROR_MSG("Error while trying to write the code of %s --- Aborts", section_to_string( s->section ));
+		}
+
+		s->base = s->size;
+	}
+}
+
+/**
+ * @param s The segment of the code.
+ * @param at Address of the code.
+ * @param type Type of the relocation.
+ * @param sym Target symbol.
+ * @return nothing
+ * @brief Solve a relocation : patch the code, in memory or in the file, and write the relocation
+ * unless it is relative or its symbol is a constant. Bytes are not patched, as in solve().
+ */
+
+static void stream_solve( segment s, unsigned int at, int type, symbol sym ) {
+	unsigned char word[4];
+	unsigned int code;
+
+	if ( type == NONE && sym->section == ABSOLUTE ) {
+		ERROR_MSG("Decode error : %s is used before its .equ", atom_text( sym->atom ));
+	}
+
+	if ( type != NONE && at >= s->base ) {
+		setCode( s, at, relocate( getCode( s, at ), type, sym, at ) );
+	}
+	else if ( type != NONE ) {
+		/* The word is already written : it is read, patched and written again in place */
+		if ( fseek( s->out, at, SEEK_SET ) != 0 || fread( word, 1, 4, s->out ) != 4 ) {
+			ERROR_MSG("Internal error : A relocation failed due to unfindable code. Please contact devs.");
+		}
+
+		code = relocate( ( (unsigned int) word[0] << 24 ) | ( (unsigned int) word[1] << 16 ) | ( (unsigned int) word[2] << 8 ) | word[3], type, sym, at );
+
+		word[0] = code >> 24;
+		word[1] = code >> 16;
+		word[2] = code >> 8;
+		word[3] = code;
+
+		fseek( s->out, at, SEEK_SET );
+		fwrite( word, 1, 4, s->out );
+		fseek( s->out, 0, SEEK_END );
+	}
+
+	if ( type != RELATIVE && sym->section != ABSOLUTE ) {
+		print_reloc( s->rels, at, type, sym );
+	}
+}
+
+/**
+ * @param sym A symbol with fixups.
+ * @param seg Segments of the sections, indexed by section.
+ * @return nothing
+ * @brief Solve the uses of a symbol which waited for its definition.
+ */
+
+static void stream_define( symbol sym, segment * seg ) {
+	struct fixup_t * f;
+
+	while ( (f = sym->fixups) != NULL ) {
+		stream_solve( seg[f->section], f->addr, f->type, sym );
+
+		sym->fixups = f->next;
+		f->next = spare;
+		spare = f;
+	}
+}
+
+/**
+ * @param t Token buffer holding the statement.
+ * @param first First token of the statement.
+ * @param n Number of tokens of the statement.
+ * @param symTab Symbol table.
+ * @param seg Segments of the sections, indexed by section.
+ * @return nothing
+ * @brief After a statement : its relocations are solved or put in the fixup chain of their symbol, the
+ * symbols it defines solve their own chain, and the listing rows are forgotten.
+ */
+
+static void stream_settle( tokens t, unsigned int first, unsigned int n, symtab symTab, segment * seg ) {
+	struct fixup_t * f;
+	segment s;
+	symbol sym;
+	rel r;
+	unsigned int i;
+	int k;
+
+	for ( k = 0; k < SECTIONS; k++ ) {
+		s = seg[k];
+
+		for ( i = 0; i < s->nrel; i++ ) {
+			r = &s->rel[i];
+
+			/* Already in the code, see eval() */
+			if ( r->solved ) {
+				print_reloc( s->rels, r->addr, r->type, r->sym );
+				continue;
+			}
+
+			if ( r->sym->section != UNDEFINED ) {
+				stream_solve( s, r->addr, r->type, r->sym );
+				continue;
+			}
+
+			if ( spare != NULL ) {
+				f = spare;
+				spare = f->next;
+			}
+			else {
+				f = arena_alloc( &arenas[ARENA_SYN], sizeof( *f ) );
+			}
+
+			f->section = k;
+			f->addr = r->addr;
+			f->type = r->type;
+			f->next = r->sym->fixups;
+			r->sym->fixups = f;
+		}
+
+		s->nrel = 0;
+		s->nrows = 0;
+
+		if ( s->size - s->base >= STREAM_CHUNK ) {
+			stream_flush( s );
+		}
+	}
+
+	/* Labels, and the symbol of .equ */
+	for ( i = first; i < first + n; i++ ) {
+
+		if ( t->type[i] == LABEL || t->type[i] == SYMBOL ) {
+			sym = findSymbol( t->lexeme[i].this.atom, symTab );
+
+			if ( sym != NULL && sym->fixups != NULL && sym->section != UNDEFINED ) {
+				stream_define( sym, seg );
+			}
+		}
+	}
+}
+
+/**
+ * @param file Assembly source file.
+ * @param instSet Instruction set.
+ * @param symTab Symbol table.
+ * @param seg Segments of the sections, indexed by section.
+ * @return nothing
+ * @brief Assemble a source in one pass. The source is read by chunks of whole lines, a line longer than
+ * a chunk makes it grow. Symbols still undefined at the end are solved like solve() does and kept in the
+ * relocation tables.
+ */
+
+void stream( char * file, isa instSet, symtab symTab, segment * seg ) {
+	FILE * fp = fopen( file, "rb" );
+	size_t size = STREAM_CHUNK;
+	size_t have = 0;
+	size_t n;
+	char * buffer = malloc( size );
+	char * token = NULL;
+	size_t tsize = 0;
+	char * p;
+	char * last;
+	unsigned int nline = 0;
+	unsigned int i;
+	int k, eof;
+
+	/* The tokens of one line, and its strings */
+	tokens t = make_tokens( 256 );
+	t->scratch = TRUE;
+
+	/* Error Management */
+	if ( fp == NULL ) {
+		ERROR_MSG("Error while trying to open %s file --- Aborts",file);
+	}
+
+	if ( buffer == NULL ) {
+		ERROR_MSG("Memory error : Malloc failed.");
+	}
+
+	seg[TEXT]->out = stream_open( "file.text" );
+	seg[DATA]->out = stream_open( "file.data" );
+
+	for ( k = 0; k < SECTIONS; k++ ) {
+		seg[k]->rels = stream_open( NULL );
+	}
+
+	do {
+		/* The buffer only holds the start of a line : it grows */
+		if ( have == size ) {
+			size = 2 * size;
+			buffer = realloc( buffer, size );
+
+			if ( buffer == NULL ) {
+				ERROR_MSG("Memory error : Malloc failed.");
+			}
+		}
+
+		n = fread( buffer + have, 1, size - have, fp );
+		have += n;
+		eof = ( n == 0 );
+
+		/* Whole lines only, the last one is read with the next chunk */
+		for ( last = buffer + have; !eof && last > buffer && last[-1] != '\n'; last-- );
+
+		for ( p = buffer; p < last; ) {
+			nline++;
+			t->count = 0;
+			t->nlines = 0;
+			atom_scratch_reset();
+
+			if ( *p != '\n' ) {
+				p = lex_read_line( p, last, nline, t, &token, &tsize, instSet );
+			}
+			else {
+				p++;
+			}
+
+			line++;
+
+			if ( t->nlines > 0 ) {
+				fetch( t, t->lines[0].first, t->lines[0].count, symTab, seg, instSet );
+				stream_settle( t, t->lines[0].first, t->lines[0].count, symTab, seg );
+			}
+		}
+
+		memmove( buffer, last, buffer + have - last );
+		have -= last - buffer;
+
+	} while ( !eof );
+
+	if ( ferror( fp ) ) {
+		ERROR_MSG("Error while trying to read %s file --- Aborts",file);
+	}
+
+	/* Symbols never defined */
+	for ( i = 0; i < symTab->count; i++ ) {
+		stream_define( symTab->sym[i], seg );
+	}
+
+	for ( k = 0; k < SECTIONS; k++ ) {
+		stream_flush( seg[k] );
+	}
+
+	fclose( seg[TEXT]->out );
+	fclose( seg[DATA]->out );
+	seg[TEXT]->out = NULL;
+	seg[DATA]->out = NULL;
+
+	fclose( fp );
+	free( buffer );
+	free( token );
+}
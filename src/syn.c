@@ -27,749 +27,468 @@
 #include <inst.h>
 #include <eval.h>
 #include <syn.h>
+#include <directive.h>
+#include <atom.h>
+#include <arena.h>
+#include <literal.h>
 
 
 
 
+/* Fields of an instruction word : bits [shift, shift + width). Immediates may be written signed or not. */
+enum { FIELD_RS, FIELD_RT, FIELD_RD, FIELD_SA, FIELD_IMM, FIELD_TARGET };
+
+static const struct field_t {
+	unsigned int shift;
+	unsigned int width;
+	int sign;
+} fields[] = {
+	{ 21,  5, UNSIGNED },
+	{ 16,  5, UNSIGNED },
+	{ 11,  5, UNSIGNED },
+	{  6,  5, UNSIGNED },
+	{  0, 16, SIGNED },
+	{  0, 26, UNSIGNED }
+};
+
+/* Bit of an operand in the operand mask of an instruction, see instSet.txt : rs rt rd sa (R), rs rt offset (I, IB, I2), target (J) */
+#define OPERAND( k )  ( 1U << (k) )
+
+/* Operands of the instruction being encoded, read one by one, and where their symbols go */
+struct operands_t {
+	lex in;
+	unsigned int n;
+	unsigned int k;
+	
+	/* Relocation of a symbol used as offset by I and IB */
+	int typeRel;
+	
+	segment seg;
+	symtab symTab;
+};
+
 /**
- * @return A int that contain the instruction.
- * @brief In this routine, we decode the instruction using the instruction set. There is 3 types of instructions. We determine the type by analysing the operation symbol.
- *
+ * @param code The instruction word.
+ * @param f The field.
+ * @param value Value of the field, negative ones in complement of 2. It must fit in the field.
+ * @return The instruction word with the field.
+ * @brief Put a value in a field.
  */
- 
-/* /!\ int is a 4 bytes type. But if you run this code in an ARM 16 bits for instance (Thumb mode), int will be coded in 2 bytes only ! The assembly will failure. (For further improvement, need to implement uint32_t structure included by ctype.h) /!\ */
 
-void decodeInstruction( chain ** c, inst * instSet ) {
+static unsigned int put( unsigned int code, int f, unsigned int value ) {
+	return code | ( ( value & ( ( 1U << fields[f].width ) - 1 ) ) << fields[f].shift );
+}
+
+/**
+ * @param f The field.
+ * @param value Value of the field, negative ones in complement of 2.
+ * @return nothing
+ * @brief Raise an error if the value does not fit in the width of the field.
+ */
+
+static void fits( int f, unsigned int value ) {
+	unsigned int limit = 1U << fields[f].width;
 	
-	chain ch = read_next( *c[0] );
-	chain symTab = *c[1];
-	chain * chCode = c[2];
-	chain * chRel = c[3];
+	if ( value >= limit && !( fields[f].sign == SIGNED && value >= 0U - ( limit >> 1 ) ) ) {
+		ERROR_MSG("Decode error : %d does not fit in the %u bits of the field", (int) value, fields[f].width );
+	}
+}
+
+/**
+ * @return The instruction word with the next operand, a register, in the field.
+ */
+
+static unsigned int reg( unsigned int code, int f, struct operands_t * o ) {
+	lex l = get_lex( o->in, o->n, &o->k );
+	unsigned int value = l->this.value;
 	
-	int i = 0;
-	int nextInst = 0;
-	int typeRel = R_MIPS_LO16;
-	unsigned int code = 0;
+	if ( l->type != REGISTER ) {
+		ERROR_MSG("Syntax error : a register is expected, not a %s", state_to_string( l->type ));
+	}
 	
+	if ( value & REGISTER_FP ) {
+		ERROR_MSG("Decode error : $f%u is a coprocessor register", value & ~REGISTER_FP );
+	}
 	
-    
-	/* We start by verifying the size of int */
-	if ( sizeof( int ) == 4 ) {
+	fits( f, value );
 	
-		/* init */
-		
-		chain in;
-		lex l;
-		
-		if (ch == NULL) {
-			ERROR_MSG("Internal error : Lexeme chain is badly written. Please contact devs.");
-		}
-		
+	return put( code, f, value );
+}
+
+/**
+ * @return The instruction word with the next operand, a number, in the field : a shift amount.
+ * Its width is known since the lexer.
+ */
+
+static unsigned int number( unsigned int code, int f, struct operands_t * o ) {
+	lex l = get_lex( o->in, o->n, &o->k );
+	unsigned int value = l->this.value;
 	
-		/* /1\ If the chain is well constructed, we can read lexeme */
-		l = read_lex( ch );
-		
-		if ( l != NULL ) {
-			
-			/* The function work here */
-			
-			i = hash( l->this.value, 1000);
-			
-			if ( instSet[i] == NULL || strcmp( instSet[i]->name, l->this.value)) {
-			
-				majuscule(l->this.value);
-				i = hash( l->this.value, 1000);
-				
-				if ( instSet[i] == NULL || strcmp( instSet[i]->name, l->this.value)) {
-					ERROR_MSG("Decode error : can not decode the symbol %s (In upper case neither)", l->this.value);
-				}
-			}
-		
-		}
-		else { /* If no lexeme, Lexeme chain is not well constructed */
-			ERROR_MSG("Decode error : Lexeme chain is badly built");
-		}
-		
-		/* /2\ We start by managing special specifications */
-		
-		/* If special == '#', we do nothing */
-		if ( strcmp(instSet[i]->special, "#") ) {
-		
-			/* init */
-			int j=0;
-			char *seps = ",=";
-			char *token = NULL;
-			chain chTemp = malloc( sizeof( *chTemp ) );
-			*chTemp = *ch;
-			
-			in = chTemp;
-			
-			
-			char* result[16] = {NULL};
-			
-			
-			for( token = strtok( instSet[i]->special, seps ); NULL != token; token = strtok( NULL, seps )) {
-        		result[j] = token;
-        		j++;
-        	}
-        	
-        	/* Special modifications depend on instruction type
-        	 * If there is any, all the operands need to by specified in order !
-        	 * Example : if you need to change rs and rt with the first and third operand of input chain, you must write something like;
-        	 * rs=A,rt=C
-        	 */
-        	
-        	j=0;
-        	
-        	/* first we verify if there is any second instrucion to do */
-        	if ( result[j][0] == '*' ) {
-        		nextInst = 1;
-        		j ++;
-        		
-        		/* We also change OP into the lexeme for the next recurvise call of decodeInstruction */
-        		strcat(l->this.value, "*");
-        		
-        		/* Case of a pseudo-instruction in two instructions => HILO reloc */
-        		typeRel = R_MIPS_HI16;
-        	}
-        	else if ( l->this.value[strlen(l->this.value) - 1] == '*' ) { /* It means that previous reloc was HI16 */
-				typeRel = R_MIPS_LO16;
-			}
-        	
-        	
-        	switch (instSet[i]->type) {
-        	
-        		case R :
-					
-					/* The special specifications must be constructed in the good order ! */
-					
-					if ( atoi(&instSet[i]->operand[2]) && !strcmp(result[j],"rd") ) {
-						chTemp = get_special( result[j+1], chTemp, ch);
-						j+=2;
-						
-					}
-					
-					if ( atoi(&instSet[i]->operand[0]) && !strcmp(result[j],"rs") ) {
-						chTemp = get_special( result[j+1], chTemp, ch);
-						j+=2;
-						
-					}
-					
-					if ( atoi(&instSet[i]->operand[1]) && !strcmp(result[j],"rt") ) {
-						chTemp = get_special( result[j+1], chTemp, ch);
-						j+=2;
-						
-					}
-					
-					if ( atoi(&instSet[i]->operand[3]) && !strcmp(result[j],"sa") ) {
-						chTemp = get_special( result[j+1], chTemp, ch);
-						j+=2;
-						
-					}
-					
-					
-					break;
-				
-				case I :
-				
-					if ( atoi(&instSet[i]->operand[1]) && !strcmp(result[j],"rt") ) {
-						chTemp = get_special( result[j+1], chTemp, ch);
-						j+=2;
-						
-					}
-					
-					if ( atoi(&instSet[i]->operand[0]) && !strcmp(result[j],"rs") ) {
-						chTemp = get_special( result[j+1], chTemp, ch);
-						j+=2;
-						
-					}
-					
-					if ( atoi(&instSet[i]->operand[2]) && !strcmp(result[j],"offset") ) {
-						chTemp = get_special( result[j+1], chTemp, ch);
-						j+=2;
-						
-					}
-			
-					j+=2; 
-
-					break;
-				
-				case IB :
-				
-					if ( atoi(&instSet[i]->operand[1]) && !strcmp(result[j],"rt") ) {
-						chTemp = get_special( result[j+1], chTemp, ch);
-						j+=2;
-						
-					}
-					
-					if ( atoi(&instSet[i]->operand[2]) && !strcmp(result[j],"offset") ) {
-						chTemp = get_special( result[j+1], chTemp, ch);
-						j+=2;
-						
-					}
-					
-					if ( atoi(&instSet[i]->operand[0]) && !strcmp(result[j],"rs") ) {
-						chTemp = get_special( result[j+1], chTemp, ch);
-						j+=2;
-						
-					}
-			
-					j+=2;
-					
-					break;
-				
-				case J :
-					if ( atoi(&instSet[i]->operand[0]) && !strcmp(result[j],"offset") ) {
-						chTemp = get_special( result[j+1], chTemp, ch);
-						j+=2;
-						
-					}
-					
-					break;
-				
-				default :
-					ERROR_MSG("Internal error : Error in instSet.txt");
-					break;
-			}
-			
-			
-			/* TODO free the other chain if nextInst = 0 */
-		
-			
-		}
-		else {
-			in = ch;
-		}
-		
-		
-		
-		
-		
-		
-		/* /3\ The type of instruction permit to verify the arguments */
-		
-		/* FROM right to left. ALSO, DO NOT CHANGE ORDER of rd, rs ... By this mecanism we test each lexeme in the good order ! */
-		
-		if (instSet[i]->type == R) {
-			
-			/* /!\ STRUCTURE /!\ */
-			
-			/* |SPECIAL|rs|rt|rd|sa|Opcode| */
-		
-			/* /!\ First, we add the opcode /!\ */
-			
-			/* Opcode 6 bits */
-			code = instSet[i]->op;
-			
-			/* /!\ Verification of operands is done there /!\ */
-			
-			
-			/* rd */
-			if ( instSet[i]->operand[2] % '0' ){
-				
-				l = get_lex( &in ); 
-				
-				code = code + (l->this.digit->value << 11);
-				
-			}
-			
-			/* rs */
-			if ( instSet[i]->operand[0] % '0' ){
-			
-				l = get_lex( &in ); 
-				
-				code = code + (l->this.digit->value << 21);
-			}
-			
-			/* rt */
-			if ( instSet[i]->operand[1] % '0' ){
-			
-				l = get_lex( &in ); 
-				
-				code = code + (l->this.digit->value << 16);
-			}
-			
-			/* sa */
-			if ( instSet[i]->operand[3] % '0' ){
-			
-				l = get_lex( &in ); 
-				
-				code = code + (l->this.digit->value << 6);
-			}
-			
-			
-			/* /!\ END /!\ */
-			
-		}
-		else if ( instSet[i]->type == I ) {
-			
-			/* /!\ STRUCTURE /!\ */
-			
-			/* |Opcode|rs|rt|offset| */
-			
-			/* /!\ Finally, we add the opcode /!\ */
-			
-			/* Opcode 6 bits */
-			
-			code = instSet[i]->op << 26;
-			
-			/* rt */
-			if ( instSet[i]->operand[1] % '0' ){
-			
-				l = get_lex( &in );
-				
-				
-				code = code + (l->this.digit->value << 16);
-			}
-			
-			/* rs */
-			if ( instSet[i]->operand[0] % '0'  ){
-			
-				l = get_lex( &in );
-				
-				code = code + (l->this.digit->value << 21);
-			}
-			
-			
-			/* offset */
-			if ( instSet[i]->operand[2] % '0'  ){
-			
-				l = get_lex( &in );
-				
-				code = code + ((eval(l, typeRel, chRel, symTab) << 16) >> 16);
-				
-			}
-			
-			
-			/* /!\ END /!\ */
-			
-		}
-		else if ( instSet[i]->type == I2 ) { /* rs and rt order different => FOR BEQ TYPE OF INSTRUCTIONS !! */
-			
-			/* /!\ STRUCTURE /!\ */
-			
-			/* |Opcode|rs|rt|offset| */
-			
-			/* /!\ Finally, we add the opcode /!\ */
-			
-			/* Opcode 6 bits */
-			
-			code = instSet[i]->op << 26;
-			
-			
-			
-			/* rs */
-			if ( instSet[i]->operand[0] % '0'  ){
-			
-				l = get_lex( &in );
-				
-				code = code + (l->this.digit->value << 21);
-			}
-			
-			/* rt */
-			if ( instSet[i]->operand[1] % '0' ){
-			
-				l = get_lex( &in );
-				
-				
-				code = code + (l->this.digit->value << 16);
-			}
-			
-			/* offset */
-			if ( instSet[i]->operand[2] % '0'  ){
-			
-				l = get_lex( &in );
-				
-				code = code + ((eval(l, RELATIVE, chRel, symTab) << 16) >> 16);
-				
-			}
-			
-			
-			/* /!\ END /!\ */
-			
-		}
-		
-		else if ( instSet[i]->type == IB ) {
-			
-			/* /!\ STRUCTURE /!\ */
-			
-			/* |Opcode|rs|rt|offset| */
-			
-			/* /!\ First, we add the opcode /!\ */
-			
-			/* Opcode 6 bits */
-			
-			code = instSet[i]->op << 26;
-		
-			
-			/* rt */
-			if ( instSet[i]->operand[1] % '0' ){
-			
-				l = get_lex( &in );
-				
-				code = code + (l->this.digit->value << 16);
-			}
-			
-			/* offset */
-			if ( instSet[i]->operand[2] % '0' ){
-			
-				l = get_lex( &in );
-				
-				code = code + ((eval(l, typeRel, chRel, symTab) << 16) >> 16); /* Keep in mind that me need to change FFFFFE00 to 0000FE00 before adding */
-				
-			}
-			
-			
-			/* rs */
-			if ( instSet[i]->operand[0] % '0' ){
-			
-				l = get_lex( &in );
-				
-				code = code + (l->this.digit->value << 21);
-			}
-			
-			
-			
-			/* /!\ END /!\ */
-			
-		}
-		else if ( instSet[i]->type == J ) {
-			
-			/* /!\ STRUCTURE /!\ */
-			
-			/* |Opcode|offset| */
-			
-			/* /!\ First, we add the opcode /!\ */
-			
-			/* Opcode 6 bits */
-			
-			code = instSet[i]->op << 26;
-			
-			/* Offset */
-			if ( instSet[i]->operand[0] % '0' ){
-				
-				l = get_lex( &in ); 
-				
-				code = code + ((eval(l, R_MIPS_26, chRel, symTab) << 26) >> 26);
-			}
-			
-			/* /!\ END /!\ */
-			
-		}	
-			
-			
+	switch ( l->type ) {
+		case DECIMAL_ZERO :
+		case BIT :
+		case DECIMAL :
+		case OCTO :
+		case HEXA :
+			break;
 		
+		default :
+			ERROR_MSG("Syntax error : a number is expected, not a %s", state_to_string( l->type ));
 	}
-	else {
-		ERROR_MSG("Critical error : size of int is not 4 bytes (Please verify if your system is running in 32/64 bits).");
+	
+	if ( !literal_fits( l, fields[f].width, fields[f].sign ) ) {
+		ERROR_MSG("Decode error : %d does not fit in the %u bits of the field", (int) value, fields[f].width );
 	}
 	
+	return put( code, f, value );
+}
+
+/**
+ * @return The instruction word with the next operand in the field, a register or a number as the
+ * instruction set says for its k-th operand.
+ */
+
+static unsigned int operand( unsigned int code, int f, inst ins, unsigned int k, struct operands_t * o ) {
+	return ( ins->registers & OPERAND( k ) ) ? reg( code, f, o ) : number( code, f, o );
+}
+
+/**
+ * @return The instruction word with the next operand, an immediate or a symbol, in the field.
+ * The width of a number is known since the lexer, a symbol is checked by its value.
+ */
+
+static unsigned int imm( unsigned int code, int f, int typeRel, struct operands_t * o ) {
+	lex l = get_lex( o->in, o->n, &o->k );
+	unsigned int value = eval( l, typeRel, o->seg, o->symTab );
+	
+	if ( l->type == SYMBOL ) {
+		fits( f, value );
+	}
+	else if ( !literal_fits( l, fields[f].width, fields[f].sign ) ) {
+		ERROR_MSG("Decode error : %d does not fit in the %u bits of the field", (int) value, fields[f].width );
+	}
 	
-	/* In the end, we add the result code in the code chain without forgetting to increment addr ! */
+	return put( code, f, value );
+}
+
+/**
+ * @brief |SPECIAL|rs|rt|rd|sa|funct|, written rd, rs, rt, sa.
+ */
 
-	addCode( chCode,  code);
+static unsigned int encode_r( inst ins, struct operands_t * o ) {
+	unsigned int code = ins->op;
 	
-	addr = addr + 4;
+	if ( ins->operands & OPERAND( 2 ) ) {
+		code = operand( code, FIELD_RD, ins, 2, o );
+	}
 	
-	if ( nextInst == 1 ) {
-		
-		/* /!\ Recursive ! /!\ */
-		decodeInstruction( c, instSet);
-		
+	if ( ins->operands & OPERAND( 0 ) ) {
+		code = operand( code, FIELD_RS, ins, 0, o );
 	}
 	
-	return;
+	if ( ins->operands & OPERAND( 1 ) ) {
+		code = operand( code, FIELD_RT, ins, 1, o );
+	}
+	
+	if ( ins->operands & OPERAND( 3 ) ) {
+		code = operand( code, FIELD_SA, ins, 3, o );
+	}
+	
+	return code;
 }
 
 /**
- * @param value Special value to implement
- * @return a new element to chain
- * @brief Routine used to create a new temporary chain of lexeme that will we free within the same loop in decode_instruction(). By building this new chain, we aim to execute it by taking into account special indications.
+ * @brief |opcode|rs|rt|offset|, written rt, rs, offset.
  */
- 
-chain get_special( char *value, chain parent, chain source ) {
-    
-	chain c = add_chain_next( parent );
-	lex l = malloc( sizeof( *l ) );
+
+static unsigned int encode_i( inst ins, struct operands_t * o ) {
+	unsigned int code = ins->op << 26;
 	
-	/* Error Management */
-	if (l == NULL) {
-		ERROR_MSG("Memory error : Malloc failed");
-    }
-    
-	int loop=0, i=0;
+	if ( ins->operands & OPERAND( 1 ) ) {
+		code = operand( code, FIELD_RT, ins, 1, o );
+	}
 	
+	if ( ins->operands & OPERAND( 0 ) ) {
+		code = operand( code, FIELD_RS, ins, 0, o );
+	}
 	
-	if ( value[0] >= 'A' && value[0] < 'Z' ) {
-		
-		/* Case when rs=A .. */
-		loop = (value[0] % 'A') +1;
-		for (i=0; i < loop; i++) {
-			
-			source = read_next(source);
-		}
-		
-		
-		l = read_lex( source );
-		
-		/* Test function
-		if (value[0] == 'B') {
-			WARNING_MSG("value B : %s %d", l->this.value, l->type);
-		} */
-		
-			
-		add_lex( c, l );
-		
+	if ( ins->operands & OPERAND( 2 ) ) {
+		code = imm( code, FIELD_IMM, o->typeRel, o );
 	}
-	else {
-		
-		/* Case when rs=00001 or offset=(in bits)  */
-		
-		if (strlen(value) < 6)
-			l = make_lex( REGISTER, value, UNSIGNED );
-		else
-			l = make_lex( BIT, value, UNSIGNED );
-		
-		add_lex( c, l );
-		
+	
+	return code;
+}
+
+/**
+ * @brief |opcode|target|, written target.
+ */
+
+static unsigned int encode_j( inst ins, struct operands_t * o ) {
+	unsigned int code = ins->op << 26;
+	
+	if ( ins->operands & OPERAND( 0 ) ) {
+		code = imm( code, FIELD_TARGET, R_MIPS_26, o );
 	}
 	
-	return c;
+	return code;
 }
 
+/**
+ * @brief |opcode|rs|rt|offset|, written rt, offset(rs) : loads and stores.
+ */
 
+static unsigned int encode_ib( inst ins, struct operands_t * o ) {
+	unsigned int code = ins->op << 26;
+	
+	if ( ins->operands & OPERAND( 1 ) ) {
+		code = operand( code, FIELD_RT, ins, 1, o );
+	}
+	
+	if ( ins->operands & OPERAND( 2 ) ) {
+		code = imm( code, FIELD_IMM, o->typeRel, o );
+	}
+	
+	if ( ins->operands & OPERAND( 0 ) ) {
+		code = operand( code, FIELD_RS, ins, 0, o );
+	}
+	
+	return code;
+}
 
 /**
- * @param ch The chain to analyse.
- * @param tab a char array used to load code byte by byte.
- * @return nothing.
- * @brief this routine decode only seleral directives. All other directives are directly managed by lex.c
- * In this routine, we manage this directives :
- * - .word w1, ... wn : put n word in contiguous way.
- * - .byte b1, ... bn : put n bytes in contiguous way.
- * - .asciiz s1, ... sn : put n string in contiguous way.
- * - .space n : put n bytes initalized to 0.
+ * @brief |opcode|rs|rt|offset|, written rs, rt, offset : branches, the offset is relative.
  */
- 
-void decodeDirective( chain ** c ) {
 
-	chain directive = read_next( *c[0] );
-	chain symTab = * c[1];
-	chain * chCode = c[2];
-	chain * chRel = c[3];
+static unsigned int encode_i2( inst ins, struct operands_t * o ) {
+	unsigned int code = ins->op << 26;
+	
+	if ( ins->operands & OPERAND( 0 ) ) {
+		code = operand( code, FIELD_RS, ins, 0, o );
+	}
+	
+	if ( ins->operands & OPERAND( 1 ) ) {
+		code = operand( code, FIELD_RT, ins, 1, o );
+	}
+	
+	if ( ins->operands & OPERAND( 2 ) ) {
+		code = imm( code, FIELD_IMM, RELATIVE, o );
+	}
+	
+	return code;
+}
+
+/* Encoder of each type of instruction, indexed by type */
+static unsigned int ( * const encoders[] )( inst, struct operands_t * ) = { encode_r, encode_i, encode_j, encode_ib, encode_i2 };
 
-	/* Note that we increase addr. Indeed, we manage here all other directives that record bytes : .word, .byte ...
-	 * The code may be larger than a word. The directive is saved byte by byte in some cases, i.e. a char (because it is the smallest data memory managed) 
-	 */
+/**
+ * @param ins The instruction.
+ * @param statement Lexemes of the instruction in the token buffer, starting with the operation symbol.
+ * @param n Number of lexemes.
+ * @param symTab Symbol table.
+ * @param seg Segments of the sections, indexed by section.
+ * @return nothing
+ * @brief Encode one instruction at the current address with the encoder of its type.
+ *
+ */
+
+static void encodeInstruction( inst ins, lex statement, unsigned int n, symtab symTab, segment * seg ) {
 	
-	unsigned int code = 0;
-	unsigned int byte = 0;
-	int i;
+	struct operands_t o;
+	unsigned int k;
 	
-	lex l = read_lex( directive );
+	/* Operands given by the special specifications of the instruction */
+	struct lexeme_t special[INST_SPECIALS];
 	
-	if ( !strcmp( l->this.value + 1, "word" ) ) {
+	/* The first instruction of a two instructions expansion takes the high half of the address, the second one the low half */
+	o.typeRel = ( ins->next >= 0 ) ? R_MIPS_HI16 : R_MIPS_LO16;
+	o.seg = seg[section];
+	o.symTab = symTab;
+	o.k = 0;
 	
+	/* The template of a pseudo-instruction gives its operands, in the order the encoder reads them.
+	 * Each one is an operand of the source or a constant (see tools/genisa.c). */
 	
-		directive = read_next( directive );
+	if ( ins->nspecials >= 0 ) {
 		
-		while (directive != NULL) { /* If the chain is well built, it is not mandatory to verify if lex is NULL */
-			l = read_lex( directive );
-			
-			if (l != NULL) {
-			
-				code = eval(l, R_MIPS_32, chRel, symTab); /* We use there all the unsigned int ! */
+		for ( k = 0; k < (unsigned int) ins->nspecials; k++ ) {
 			
-				addCode( chCode, code );
-				addr = addr + 4;
+			if ( ins->specials[k].source < 0 ) {
+				special[k] = ins->specials[k].lexeme;
+			}
+			else if ( (unsigned int) ins->specials[k].source < n - 1 ) {
+				special[k] = statement[1 + ins->specials[k].source];
+			}
+			else {
+				ERROR_MSG("Syntax error : an operand is missing");
 			}
-			
-			directive = read_next( directive );
 		}
 		
-		
-		
+		o.in = special;
+		o.n = ins->nspecials;
+	}
+	else {
+		o.in = statement + 1;
+		o.n = n - 1;
 	}
-	else if ( !strcmp( l->this.value + 1, "byte" ) ) {
 	
-		typeCode = BYTE;
-		directive = read_next( directive );
-		
-		while (directive != NULL) {
-			l = read_lex( directive );
-			
-			if (l != NULL) {
-			
-				code = ((eval(l, NONE, chRel, symTab) << 24) >> 24 ); /* We need only the first 8 bits */
-			
-				addCode( chCode, code );
-				addr = addr + 1;
-			}
-			
-			directive = read_next( directive );
-		}
-		
-		
+	if ( ins->type < R || ins->type > I2 ) {
+		ERROR_MSG("Internal error : Error in instSet.txt");
 	}
-	else if ( !strcmp( l->this.value + 1, "asciiz" ) ) {
 	
-		typeCode = BYTE;
-		directive = read_next( directive );
-		
-		
-		while (directive != NULL) { 
-			l = read_lex( directive );
-			
-			/* Here we add each string and we finish it by a char '\0', after that we translate using variable i */
-			WARNING_MSG("%s",l->this.value);
-			while ( byte < strlen(l->this.value) - 2 ) {
-				
-				code = l->this.value[byte];
-
-				addCode( chCode, code );
-				byte++;
-				addr = addr + 1; /* Address is incremented byte by byte */
-			}
-			
-			directive = read_next( directive );
-		}
-		
-		
+	/* In the end, we add the result code in the segment without forgetting to increment addr ! */
+
+	addCode( seg[section], encoders[ins->type]( ins, &o ) );
+	
+	addr = addr + 4;
+	
+	return;
+}
+
+/**
+ * @param id Number of the instruction in the instruction set, found by the lexer.
+ * @param statement Lexemes of the instruction in the token buffer, starting with the operation symbol.
+ * @param n Number of lexemes.
+ * @param symTab Symbol table.
+ * @param seg Segments of the sections, indexed by section.
+ * @param instSet Instruction Set.
+ * @return nothing
+ * @brief In this routine, we decode the instruction using the instruction set. A pseudo-instruction is expanded
+ * in place : each instruction of its expansion is encoded in turn, with the operands of its template.
+ *
+ */
+
+void decodeInstruction( unsigned int id, lex statement, unsigned int n, symtab symTab, segment * seg, isa instSet ) {
+	
+	/* Instructions of the expansion, in order. No chain is longer (see inst.c) */
+	inst expansion[INST_EXPANSION];
+	unsigned int count = 0;
+	unsigned int k;
+	inst ins;
+	
+	if ( n == 0 || id >= instSet->ninst ) {
+		ERROR_MSG("Internal error : Token buffer is badly written. Please contact devs.");
 	}
-	else if ( !strcmp( l->this.value + 1, "space" ) ) {
 	
-		typeCode = BYTE;
-		directive = read_next( directive );
+	/* /1\ The lexer has already found the instruction of the operation symbol, its template links the next ones */
+	
+	for ( ins = &instSet->set[id]; count < INST_EXPANSION; ins = &instSet->set[ins->next] ) {
+		expansion[count++] = ins;
 		
-		if (directive != NULL) { /* If the chain is well built, it is not mandatory to verify if lex is NULL */
-			l = read_lex( directive );
-			code = 0;
-			
-			int n = l->this.digit->this.integer; /* Number of uninitialized bytes */
-			for (i=0; i<n; i++) {
-				addCode( chCode, 0 );
-				addr = addr + 1;
-			}
+		if ( ins->next < 0 ) {
+			break;
 		}
-		
-		
-	}
-	else {
-		ERROR_MSG("Decode error : directive %s unknown", l->this.value);
 	}
 	
-	/* In all way we put typeCode at WORD */
-	typeCode = WORD;
+	if ( expansion[count - 1]->next >= 0 ) {
+		ERROR_MSG("Internal error : the expansion of %s is longer than %d instructions", instSet->set[id].name, INST_EXPANSION);
+	}
 	
+	/* /2\ Each instruction of the expansion is encoded in turn */
 	
+	for ( k = 0; k < count; k++ ) {
+		encodeInstruction( expansion[k], statement, n, symTab, seg );
+	}
 	
- 	return;
- 
- }
+	return;
+}
 
 
+/**
+ * @param t Token buffer built by lex.c
+ * @param first First token of the statement.
+ * @param end Token after the statement.
+ * @param symTab Symbol table.
+ * @param seg Segments of the sections, indexed by section.
+ * @return The first token after the labels.
+ * @brief Define the labels of a statement at the current address.
+ */
 
+unsigned int fetchLabels( tokens t, unsigned int first, unsigned int end, symtab symTab, segment * seg ) {
+	
+	lex l = &t->lexeme[first];
+	
+	for ( ; first < end && t->type[first] == LABEL; first++, l++ ) {
+		
+		/* A label on aligned data is the address of the data */
+		if ( first + 1 < end && t->type[first + 1] == DIRECTIVE ) {
+			alignDirective( l + 1, seg );
+		}
+		
+		addSymbol( l->this.atom, symTab, 1);
+	}
+	
+	return first;
+}
 
 /**
- * @param ch Chain built by lex.c
- * @param symTab Last element of the symbol chain.
- * @param code The code chain. In fact, this is return of this routine.
- * @param section Pointer on the section, if NULL, no section defined yet.
- * @param addr Address in this section, if NULL, no section defined yet.
+ * @param t Token buffer built by lex.c
+ * @param first First token of the statement.
+ * @param n Number of tokens of the statement.
+ * @param symTab Symbol table.
+ * @param seg Segments of the sections, indexed by section.
  * @param instSet Instruction Set if instruction decode is needed.
  * @return nothing 
- * @brief This routine is used to fetch and decode if needed the input intruction. 
+ * @brief This routine is used to fetch and decode if needed the input intruction.
+ * A statement is read in order, without recursion : its labels, then a directive or an instruction.
  */
  
- void fetch( chain ** c, inst * instSet ) {
- 	chain element = *c[0];
- 	chain * symTab = c[1];
+void fetch( tokens t, unsigned int first, unsigned int n, symtab symTab, segment * seg, isa instSet ) {
  	
- 	lex l;
- 	
- 	/* We read the line */
- 	element = read_next( element );
-	l = read_lex( element );
+	lex l;
+	unsigned int end = first + n;
 	
-	/* We get the line value; it is mandatory to add it to chain chRel symTab .. */
-	line = element->line;
- 	
- 	/* If line is not empty, we analyse it */
- 	
- 	if ( l != NULL ) {
- 	
-	 	if (  l->type == DIRECTIVE ) {
-	 	
-	 		
-	 		
-	 		
-	 		if ( !strcmp( l->this.value + 1, "text" ) ) {
-	 			section = TEXT;
-	 			addr = 0;
-	 		}
-	 		else if ( !strcmp( l->this.value + 1, "data" ) ) {
-	 			section = DATA;
-	 			addr = 0;
-	 		}
-	 		else if ( !strcmp( l->this.value + 1, "bss" ) ) {
-	 			section = BSS;
-	 			addr = 0;
-	 		}
-	 		else if ( !strcmp( l->this.value + 1, "set" ) ) {
-	 			/* We ignore this directive for the moment, it will be used once optimisation has been coded */
-	 			
-	 		}
-	 		else {
-	 		
-	 			decodeDirective( c );
-	 			
-	 		}
-	 		
-	 	}
-	 	else if ( l->type == LABEL ) {
-	 		/* Here, it is a label, we add it to symTab without forgetting some verifications ;). After that, we launch fetch again to treat rest of the chain */
-	 		
-		 	addSymbol( l->this.value , *symTab, 1);
-		 
-		 	
-	 		if (read_next( element ) != NULL ) {
-	 			
-	 			/* /!\ Recursive /!\ */
-	 			/* It is mandotory to proceed this way in order to avoid stack overflow */
-	 			chain * cFetch[4] = { &element, c[1], c[2], c[3] };		
-	 			
-		 		fetch( cFetch, instSet );
-		 	}
-		 	
-	 	}
-	 	else {
-	 		/* The list is not empty, we are in the case of instruction */
-
-	 		decodeInstruction( c , instSet );
-	 		
-	 	}
+	/* We get the line value; it is mandatory to add it to relocations, symTab .. */
+	line = t->lines[t->line[first]].line;
+	
+	/* /1\ Labels : we add them to symTab without forgetting some verifications ;) */
+	
+	first = fetchLabels( t, first, end, symTab, seg );
+	l = &t->lexeme[first];
+	
+	/* /2\ The rest of the line, if any, is a directive or an instruction */
+	
+	if ( first == end ) {
+		return;
+	}
+	
+	switch ( t->type[first] ) {
+		case DIRECTIVE :
+			/* The descriptor of the directive says what to do, see directive.c */
+			decodeDirective( l, end - first, symTab, seg );
+			break;
+		
+		case MNEMONIC :
+			decodeInstruction( l->this.id, l, end - first, symTab, seg, instSet );
+			break;
+		
+		case SYMBOL :
+			/* The lexer did not find this symbol in the instruction set */
+			ERROR_MSG("Decode error : can not decode the symbol %s", atom_text( l->this.atom ));
+			break;
+		
+		default :
+			ERROR_MSG("Decode error : an instruction can not start with a %s", state_to_string( t->type[first] ) );
+			break;
 	}
 	
 	return;
- }
+}
  
 /**
- * @param element chain element which contains lexeme.
- * @return nothing
+ * @param operands Operands of the instruction.
+ * @param n Number of operands.
+ * @param k Index of the next operand to read, incremented.
+ * @return The operand.
  * @brief Get lexeme. Raise an error if missing.
  */
-lex get_lex( chain * element ) {
-	lex l;
-	
-	*element = read_next( *element );
-	l = read_lex( *element );
+lex get_lex( lex operands, unsigned int n, unsigned int * k ) {
 	
-	/* If NULL, raise an error */
-	if ( l == NULL ) {
+	/* If there is no more operand, raise an error */
+	if ( *k >= n ) {
 		ERROR_MSG("Syntax error : an operand is missing");
 	}
 
-	return l;
+	return &operands[(*k)++];
 }
  
 
@@ -777,75 +496,79 @@ lex get_lex( chain * element ) {
 /* ##### Code functions ##### */
 
 /**
- * @param line The line of the code. Can be used to final display. (Is like an ID)
- * @param addr Mandatory, the address of the code regarding to the section
+ * @param s The segment of the current section.
  * @param value Unsigned int to store the code
- * @return a code.
- * @brief Add the code to the chain.
+ * @return nothing
+ * @brief Add the code at the current address of the segment. The address is incremented by the caller.
  */
 
-void addCode( chain * chCode, unsigned int value ) {
-	/* We add a new element in the chain code */
-	*chCode = add_chain_next( *chCode );
+void addCode( segment s, unsigned int value ) {
+	
+	if ( s->section == BSS ) {
+		ERROR_MSG("Decode error : only .space can be used in .bss");
+	}
+	
+	reserve_segment( s, addr + 4 );
+	add_segment_row( s, WORD, 4 );
+	setCode( s, addr, value );
 	
-	(*chCode)->this.c = createCode(addr, value);
 	return;
 }
 
 /**
- * @param line The line of the code. Can be used to final display. (Is like an ID)
- * @param addr Mandatory, the address of the code regarding to the section
- * @param value Unsigned int to store the code
- * @return a code.
- * @brief Create a code container
+ * @param s The segment of the current section.
+ * @param type BYTE or SPACE.
+ * @param bytes The bytes of the run, NULL for SPACE. NULL for BYTE if the caller writes them in the segment.
+ * @param size Number of bytes.
+ * @return nothing
+ * @brief Add a data run at the current address : one row for all the bytes of a directive.
  */
 
-code createCode( unsigned int addr, unsigned int value ) {
-	code c = malloc ( sizeof( *c ) );
+void addData( segment s, int type, unsigned char * bytes, unsigned int size ) {
+	
+	if ( s->section == BSS && type != SPACE ) {
+		ERROR_MSG("Decode error : only .space can be used in .bss");
+	}
 	
-	c->type = typeCode;
-	c->section = section;
-	c->line = line;
-	c->addr = addr;
-	c->value = value;
+	reserve_segment( s, addr + size );
+	add_segment_row( s, type, size );
 	
+	/* A space is already filled with zeros */
+	if ( type == BYTE && bytes != NULL ) {
+		memcpy( s->data + addr - s->base, bytes, size );
+	}
 	
-	return c;
+	return;
 }
 
 /**
- * @param chCode The chain to analyse
- * @return a code.
+ * @param s The segment.
+ * @param addr Address of the code in the section.
+ * @return The word at this address.
  * @brief A simple way to get the code.
  */
 
-code getCode( chain chCode ) {
+unsigned int getCode( segment s, unsigned int addr ) {
+	unsigned char * p = s->data + addr - s->base;
 	
-	if( chCode->this.c != NULL )
-		return chCode->this.c;
-	
-	return NULL;
+	return ( (unsigned int) p[0] << 24 ) | ( (unsigned int) p[1] << 16 ) | ( (unsigned int) p[2] << 8 ) | p[3];
 }
 
-
 /**
- * @param chCode The chain to analyse
- * @return a code.
- * @brief A simple way to find code using address.
+ * @param s The segment.
+ * @param addr Address of the code in the section.
+ * @param value The new word.
+ * @return nothing
+ * @brief Write a word, big endian.
  */
 
-code findCode( chain chCode, unsigned int addr ) {
-	code c;
-	while ( chCode != NULL ) {
-		c = getCode( chCode );
-		if ( c->addr == addr )
-			return c;
-			
-		chCode = read_next( chCode );
-	}
+void setCode( segment s, unsigned int addr, unsigned int value ) {
+	unsigned char * p = s->data + addr - s->base;
 	
-	
-	return NULL;
+	p[0] = value >> 24;
+	p[1] = value >> 16;
+	p[2] = value >> 8;
+	p[3] = value;
 }
 
 
@@ -856,3 +579,4 @@ code findCode( chain chCode, unsigned int addr ) {
 
 
 
+
@@ -0,0 +1,4 @@
+# TEST_RETURN_CODE=FAIL
+# add attend des registres, pas un nombre
+.text
+	add $t0, 5, $t1
@@ -0,0 +1,4 @@
+# TEST_RETURN_CODE=FAIL
+# add attend des registres, pas un symbole
+.text
+	add $t0, foo, $t1
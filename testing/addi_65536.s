@@ -0,0 +1,4 @@
+# TEST_RETURN_CODE=FAIL
+# l'immediat de addi tient sur 16 bits
+.text
+	addi $t0, $t1, 65536
@@ -0,0 +1,23 @@
+  1                   # TEST_RETURN_CODE=PASS
+  2                   # .word et .half s'alignent seuls sur 4 et 2 octets, les etiquettes avec eux
+  3                   .data
+  4 00000000 01       	.byte 1
+  5 00000002 0002     demi:	.half 2
+  6 00000004 03       	.byte 3
+  7 00000008 00000004 mot:	.word 4
+  8 0000000C 050607   	.byte 5, 6, 7
+  9 00000010 0008     	.half 8
+ 10 00000012 0009     	.half 9
+ 11 00000014 0A       	.byte 10
+ 12 00000018 0000000B 	.word 11
+ 13 0000001C 6100     	.asciiz "a"
+ 14 0000001E 000C000D deux:	.half 12, 13
+
+.symtab
+  5	.data:00000002	demi
+  7	.data:00000008	mot
+ 14	.data:0000001E	deux
+
+rel.text
+
+rel.data
@@ -0,0 +1,14 @@
+# TEST_RETURN_CODE=PASS
+# .word et .half s'alignent seuls sur 4 et 2 octets, les etiquettes avec eux
+.data
+	.byte 1
+demi:	.half 2
+	.byte 3
+mot:	.word 4
+	.byte 5, 6, 7
+	.half 8
+	.half 9
+	.byte 10
+	.word 11
+	.asciiz "a"
+deux:	.half 12, 13
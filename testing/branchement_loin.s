@@ -0,0 +1,6 @@
+# TEST_RETURN_CODE=FAIL
+# un branchement en avant ne va pas au-dela de 32767 instructions
+.text
+	beq $t0, $t1, loin
+	.space 131072
+loin:	nop
@@ -0,0 +1,20 @@
+  1                   # TEST_RETURN_CODE=PASS
+  2                   # branchements en avant et en arriere, jusqu'aux bornes du decalage de 16 bits
+  3                   .text
+  4 00000000 11090001 debut:	beq $t0, $t1, suite
+  5 00000004 00000000 	nop
+  6 00000008 1509FFFD suite:	bne $t0, $t1, debut
+  7 0000000C 11097FFF 	beq $t0, $t1, loin
+  8 00000010 0000...  	.space 131068
+  9 0002000C 00000000 loin:	nop
+ 10 00020010 0000...  	.space 131064
+ 11 00040008 15098000 	bne $t0, $t1, loin
+
+.symtab
+  4	.text:00000000	debut
+  6	.text:00000008	suite
+  9	.text:0002000C	loin
+
+rel.text
+
+rel.data
@@ -0,0 +1,11 @@
+# TEST_RETURN_CODE=PASS
+# branchements en avant et en arriere, jusqu'aux bornes du decalage de 16 bits
+.text
+debut:	beq $t0, $t1, suite
+	nop
+suite:	bne $t0, $t1, debut
+	beq $t0, $t1, loin
+	.space 131068
+loin:	nop
+	.space 131064
+	bne $t0, $t1, loin
@@ -0,0 +1,4 @@
+# TEST_RETURN_CODE=FAIL
+# un .half va de -32768 a 65535
+.data
+	.half 2, -32769
@@ -0,0 +1,41 @@
+  1                   # TEST_RETURN_CODE=PASS
+  2                   # .globl, .extern, .equ, .half, .ascii, .align et .incbin
+  3                   	.globl main
+  4                   	.extern printf
+  5                   	.equ TAILLE, 12
+  6                   	.equ MASQUE, 0xFF
+  7                   .text
+  8 00000000 2008000C main:	addi $t0, $zero, TAILLE
+  9 00000004 200900FF 	addi $t1, $zero, MASQUE
+ 10 00000008 0C000000 	jal printf
+ 11 0000000C 00000000 	nop
+ 12                   .data
+ 13 00000000 1234FFFE demi:	.half 0x1234, -2, 65535, -32768
+ 13 00000004 FFFF8000 
+ 14 00000008 6162     chaine:	.ascii "ab", "c"
+ 14 0000000A 63       
+ 15 0000000B 00       	.byte 0
+ 16                   	.align 3
+ 17 00000010 09       aligne:	.byte 9
+ 18 00000011 41424344 fichier:	.incbin "testing/directives.bin"
+ 18 00000015 45       
+ 19 00000016 0CFF     	.byte TAILLE, MASQUE
+ 20 00000018 00000000 	.word printf, demi
+ 20 0000001C 00000000 
+
+.symtab
+  4	[UNDEFINED]	printf	GLOBAL
+  5	ABS :0000000C	TAILLE
+  6	ABS :000000FF	MASQUE
+  8	.text:00000000	main	GLOBAL
+ 13	.data:00000000	demi
+ 14	.data:00000008	chaine
+ 17	.data:00000010	aligne
+ 18	.data:00000011	fichier
+
+rel.text
+00000008	R_MIPS_26	[UNDEFINED]	printf
+
+rel.data
+00000018	R_MIPS_32	[UNDEFINED]	printf
+0000001c	R_MIPS_32	.data:00000000	demi
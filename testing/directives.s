@@ -0,0 +1,20 @@
+# TEST_RETURN_CODE=PASS
+# .globl, .extern, .equ, .half, .ascii, .align et .incbin
+	.globl main
+	.extern printf
+	.equ TAILLE, 12
+	.equ MASQUE, 0xFF
+.text
+main:	addi $t0, $zero, TAILLE
+	addi $t1, $zero, MASQUE
+	jal printf
+	nop
+.data
+demi:	.half 0x1234, -2, 65535, -32768
+chaine:	.ascii "ab", "c"
+	.byte 0
+	.align 3
+aligne:	.byte 9
+fichier:	.incbin "testing/directives.bin"
+	.byte TAILLE, MASQUE
+	.word printf, demi
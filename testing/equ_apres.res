@@ -0,0 +1,14 @@
+  1                   # TEST_RETURN_CODE=PASS
+  2                   # une constante .equ utilisee avant sa definition est remplacee, sans relocation
+  3                   .text
+  4 00000000 200900FF 	addi $t1, $zero, MASQUE
+  5 00000004 3C0A00FF 	lui $t2, MASQUE
+  6                   	.equ MASQUE, 0xFF
+  7 00000008 200900FF 	addi $t1, $zero, MASQUE
+
+.symtab
+  6	ABS :000000FF	MASQUE
+
+rel.text
+
+rel.data
@@ -0,0 +1,7 @@
+# TEST_RETURN_CODE=PASS
+# une constante .equ utilisee avant sa definition est remplacee, sans relocation
+.text
+	addi $t1, $zero, MASQUE
+	lui $t2, MASQUE
+	.equ MASQUE, 0xFF
+	addi $t1, $zero, MASQUE
@@ -0,0 +1,5 @@
+# TEST_RETURN_CODE=FAIL
+# un .byte ne peut pas utiliser une constante .equ definie apres
+.data
+	.byte X
+	.equ X, 3
@@ -0,0 +1,4 @@
+# TEST_RETURN_CODE=FAIL
+# un litteral hexadecimal ne depasse pas 32 bits
+.data
+	.word 0x100000000
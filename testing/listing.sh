@@ -0,0 +1,23 @@
+#! /bin/bash
+#
+#listing.sh
+#
+########################################
+# as-mips writes its listing in file.l : this runs as-mips on a test file and keeps the listing
+# as <testfile>.l, where simpleUnitTest.sh looks for it.
+#
+# From the directory of as-mips :
+#	testing/simpleUnitTest.sh -e testing/listing.sh -b testing/*.s
+########################################
+
+AS_MIPS="`dirname $0`/../as-mips"
+
+"$AS_MIPS" "$@"
+code=$?
+
+if [ $code -eq 0 ]
+then
+	cp file.l "${1%.*}.l"
+fi
+
+exit $code
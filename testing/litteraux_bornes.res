@@ -0,0 +1,15 @@
+  1                   # TEST_RETURN_CODE=PASS
+  2                   # les plus grands litteraux sur 32 bits, en octal et en decimal, et les bornes de addi
+  3                   .data
+  4 00000000 FFFFFFFF 	.word 037777777777, 4294967295, -2147483648
+  4 00000004 FFFFFFFF 
+  4 00000008 80000000 
+  5                   .text
+  6 00000000 2128FFFF 	addi $t0, $t1, 65535
+  7 00000004 21288000 	addi $t0, $t1, -32768
+
+.symtab
+
+rel.text
+
+rel.data
@@ -0,0 +1,7 @@
+# TEST_RETURN_CODE=PASS
+# les plus grands litteraux sur 32 bits, en octal et en decimal, et les bornes de addi
+.data
+	.word 037777777777, 4294967295, -2147483648
+.text
+	addi $t0, $t1, 65535
+	addi $t0, $t1, -32768
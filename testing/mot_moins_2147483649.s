@@ -0,0 +1,4 @@
+# TEST_RETURN_CODE=FAIL
+# un litteral negatif ne depasse pas 32 bits
+.data
+	.word -2147483649
@@ -0,0 +1,4 @@
+# TEST_RETURN_CODE=FAIL
+# un litteral octal ne depasse pas 32 bits
+.data
+	.word 040000000000
@@ -0,0 +1,4 @@
+# TEST_RETURN_CODE=FAIL
+# un .byte va de -128 a 255
+.data
+	.byte -129
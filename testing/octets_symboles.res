@@ -0,0 +1,20 @@
+  1                   # TEST_RETURN_CODE=PASS
+  2                   # chaque symbole d'un .byte ou d'un .half est reloge a l'adresse de sa valeur
+  3                   .data
+  4 00000000 07       	.byte 7
+  5 00000001 000003   	.byte premier, second, 3
+  6 00000004 00000000 	.half premier, second
+  7 00000008 01       premier:	.byte 1
+  8 00000009 02       second:	.byte 2
+
+.symtab
+  7	.data:00000008	premier
+  8	.data:00000009	second
+
+rel.text
+
+rel.data
+00000001	NONE	.data:00000008	premier
+00000002	NONE	.data:00000009	second
+00000004	NONE	.data:00000008	premier
+00000006	NONE	.data:00000009	second
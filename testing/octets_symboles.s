@@ -0,0 +1,8 @@
+# TEST_RETURN_CODE=PASS
+# chaque symbole d'un .byte ou d'un .half est reloge a l'adresse de sa valeur
+.data
+	.byte 7
+	.byte premier, second, 3
+	.half premier, second
+premier:	.byte 1
+second:	.byte 2
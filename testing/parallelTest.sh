@@ -0,0 +1,114 @@
+#! /bin/bash
+#
+#parallelTest.sh
+#
+########################################
+# Checks that -j gives the listing of the serial assembly : each source is assembled without -j, then with
+# -j N for each N, and file.l must be the same. A source the serial assembly rejects must be rejected too.
+# A generated source is added to the given ones : it is long enough to be lexed in chunks and encoded in
+# several blocks (see src/lex.c and src/parallel.c).
+#
+# From the directory of as-mips (the sources may use paths relative to it, like .incbin) :
+#	testing/parallelTest.sh [-e <executablefile>] [-j "<N1> <N2> ..."] [<sources>]
+# Default : ./as-mips, -j "2 3 8", testing/*.s and tests/*.s tests/*/*.s
+########################################
+
+AS_MIPS=./as-mips
+THREADS="2 3 8"
+
+while getopts e:j: OPT
+do
+	case "$OPT" in
+	e)
+		AS_MIPS="$OPTARG"
+		;;
+	j)
+		THREADS="$OPTARG"
+		;;
+	\?)
+		exit 1
+		;;
+	esac
+done
+
+shift `expr $OPTIND - 1`
+SOURCES=${*:-`ls testing/*.s tests/*.s tests/*/*.s 2> /dev/null`}
+
+WORK=`mktemp -d`
+trap 'rm -rf "$WORK"' EXIT
+
+#############################
+# Generated source : about 300000 lines, labels used before and after their definition
+#############################
+{
+	echo "# TEST_RETURN_CODE=PASS"
+	for (( b = 0; b < 3000; b++ ))
+	do
+		echo ".text"
+		echo "bloc$b:	addi \$t0, \$t0, $b	# commentaire du bloc $b"
+		echo "	beq \$t0, \$t1, bloc$(( b + 1 ))"
+		echo "	Lw \$t2, mot$b"
+		echo "	sll \$t3, \$t2, $(( b % 32 ))"
+		echo "	jal bloc$(( b / 2 ))"
+		for (( i = 0; i < 80; i++ ))
+		do
+			echo "	add \$t$(( i % 8 )), \$s$(( b % 8 )), \$a$(( i % 4 ))"
+		done
+		echo ".data"
+		echo "mot$b:	.word bloc$b, mot$(( b + 1 ))"
+		echo "	.asciiz \"bloc $b\""
+		echo "	.half $b"
+	done
+	echo ".text"
+	echo "bloc3000:	nop"
+	echo ".data"
+	echo "mot3000:	.word 0"
+} > "$WORK/parallel.s"
+
+#############################
+# Serial, then parallel
+#############################
+failed=0
+count=0
+
+for source in $SOURCES "$WORK/parallel.s"
+do
+	rm -f file.l
+	"$AS_MIPS" -l "$source" > /dev/null 2>&1
+	serial=$?
+
+	if [ $serial -eq 0 ]
+	then
+		cp file.l "$WORK/serial.l"
+	fi
+
+	for n in $THREADS
+	do
+		rm -f file.l
+		"$AS_MIPS" -l -j $n "$source" > /dev/null 2>&1
+		code=$?
+		count=`expr $count + 1`
+
+		if [ $serial -ne 0 ]
+		then
+			if [ $code -eq 0 ]
+			then
+				echo "parallelTest : $source is rejected alone, not with -j $n"
+				failed=`expr $failed + 1`
+			fi
+		elif [ $code -ne 0 ]
+		then
+			echo "parallelTest : $source fails with -j $n (code $code)"
+			failed=`expr $failed + 1`
+		elif ! cmp -s file.l "$WORK/serial.l"
+		then
+			echo "parallelTest : the listing of $source differs with -j $n"
+			diff "$WORK/serial.l" file.l | head -5
+			failed=`expr $failed + 1`
+		fi
+	done
+done
+
+echo "parallelTest : $failed wrong out of $count runs (-j $THREADS)"
+
+[ $failed -eq 0 ]
@@ -0,0 +1,4 @@
+# TEST_RETURN_CODE=FAIL
+# $t sans numero n'est pas un registre
+.text
+	add $t0, $t1, $t
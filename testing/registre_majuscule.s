@@ -0,0 +1,4 @@
+# TEST_RETURN_CODE=FAIL
+# les noms des registres sont en minuscules
+.text
+	add $T0, $t1, $t2
@@ -0,0 +1,4 @@
+# TEST_RETURN_CODE=FAIL
+# $s0 a $s7 puis $s8 : $s9 n'est pas un registre
+.text
+	add $t0, $s9, $t1
@@ -0,0 +1,4 @@
+# TEST_RETURN_CODE=FAIL
+# $t8 et $t9 sont les derniers $t : $t10 n'est pas un registre
+.text
+	add $t10, $t0, $t1
@@ -0,0 +1,14 @@
+  1                   # TEST_RETURN_CODE=PASS
+  2                   # $k0 et $k1 sont les registres 26 et 27, $s8 est un autre nom de $fp (30)
+  3                   .text
+  4 00000000 0360D020 	add $k0, $k1, $zero
+  5 00000004 0360D020 	add $26, $27, $0
+  6 00000008 03DEF020 	add $s8, $fp, $30
+  7 0000000C 033FC020 	add $t8, $t9, $ra
+  8 00000010 03E00008 	jr $ra
+
+.symtab
+
+rel.text
+
+rel.data
@@ -0,0 +1,8 @@
+# TEST_RETURN_CODE=PASS
+# $k0 et $k1 sont les registres 26 et 27, $s8 est un autre nom de $fp (30)
+.text
+	add $k0, $k1, $zero
+	add $26, $27, $0
+	add $s8, $fp, $30
+	add $t8, $t9, $ra
+	jr $ra
@@ -0,0 +1,4 @@
+# TEST_RETURN_CODE=FAIL
+# le decalage de sll tient sur 5 bits
+.text
+	sll $t0, $t1, 32
@@ -0,0 +1,4 @@
+# TEST_RETURN_CODE=FAIL
+# le decalage de sll est un nombre, pas un registre
+.text
+	sll $t0, $t1, $t2
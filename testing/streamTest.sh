@@ -0,0 +1,187 @@
+#! /bin/bash
+#
+#streamTest.sh
+#
+########################################
+# Checks the one pass mode (-s) against the listing of the same source : file.text and file.data must hold
+# the bytes of the listing at their address, file.sym its symbols and its relocations.
+# The generated source has more than a chunk of code (STREAM_CHUNK, see src/stream.c) before the labels it
+# uses, so that the forward references are patched in file.text after their bytes are written.
+# Then a source of .byte and .half lines, much bigger, must be assembled with -s in the memory the first one
+# needed : the memory of -s must not grow with the source.
+#
+# From the directory of as-mips :
+#	testing/streamTest.sh [<executablefile>]
+########################################
+
+AS_MIPS=`readlink -f "${1:-./as-mips}"`
+WORK=`mktemp -d`
+trap 'rm -rf "$WORK"' EXIT
+
+# More than 65536 bytes of code and of data before the labels
+INSTRUCTIONS=20000
+STRINGS=2000
+
+cd "$WORK" || exit 1
+
+#############################
+# Source
+#############################
+{
+	echo "# TEST_RETURN_CODE=PASS"
+	echo ".text"
+	echo "debut:	j fin"
+	echo "	beq \$t0, \$t1, fin"
+	echo "	Lw \$t2, loin"
+	echo "	addi \$t3, \$zero, TAILLE"
+	echo "	jal dehors"
+	for (( i = 0; i < INSTRUCTIONS; i++ ))
+	do
+		echo "	addi \$t0, \$t0, 1"
+	done
+	echo "fin:	beq \$t0, \$t1, debut"
+	echo "	j debut"
+	echo ".data"
+	echo "	.word fin, loin, dehors"
+	for (( i = 0; i < STRINGS; i++ ))
+	do
+		echo "	.asciiz \"chaine $i, assez longue pour remplir un morceau\""
+		echo "	.byte $(( i % 256 )), -1"
+		echo "	.half $i, -$i"
+	done
+	echo "	.byte 1"
+	echo "loin:	.word debut, loin"
+	echo "	.half 2"
+	echo "	.equ TAILLE, 0x100"
+} > source.s
+
+#############################
+# Both modes
+#############################
+if ! "$AS_MIPS" -l source.s > /dev/null 2> as.err
+then
+	cat as.err
+	echo "streamTest : the listing failed"
+	exit 1
+fi
+
+mv file.l source.l
+
+if ! "$AS_MIPS" -s source.s > /dev/null 2> as.err
+then
+	cat as.err
+	echo "streamTest : -s failed"
+	exit 1
+fi
+
+#############################
+# Bytes of each section, read from the listing : its rows are "line address bytes source", the source
+# starts at column 23. The padding of the alignments is made of zeros.
+#############################
+awk '
+	function hex( h,    v, i ) {
+		v = 0
+		for ( i = 1; i <= length( h ); i++ ) {
+			v = 16 * v + index( "0123456789ABCDEF", substr( h, i, 1 ) ) - 1
+		}
+		return v
+	}
+
+	function section_of( source ) {
+		if ( source ~ /^[ \t]*\.text/ ) return "text"
+		if ( source ~ /^[ \t]*\.data/ ) return "data"
+		if ( source ~ /^[ \t]*\.bss/ ) return "bss"
+		return ""
+	}
+
+	/^\.symtab/ { exit }
+
+	{
+		s = section_of( substr( $0, 23 ) )
+		if ( s != "" ) current = s
+	}
+
+	$1 ~ /^[0-9]+$/ && length( $2 ) == 8 && $2 ~ /^[0-9A-F]+$/ && $3 ~ /^[0-9A-F]+$/ && current != "bss" {
+		at = hex( $2 )
+		for ( i = 0; i < length( $3 ) / 2; i++ ) {
+			byte[current, at + i] = tolower( substr( $3, 2 * i + 1, 2 ) )
+			if ( at + i + 1 > size[current] ) size[current] = at + i + 1
+		}
+	}
+
+	END {
+		for ( s in size ) {
+			file = "listing." s
+			for ( i = 0; i < size[s]; i++ ) {
+				print ( ( s, i ) in byte ) ? byte[s, i] : "00" > file
+			}
+		}
+	}
+' source.l
+
+for s in text data
+do
+	touch listing.$s
+	od -An -v -tx1 file.$s | tr -s ' ' '\n' | sed '/^$/d' > stream.$s
+
+	if ! cmp -s listing.$s stream.$s
+	then
+		echo "streamTest : file.$s differs from the listing"
+		diff listing.$s stream.$s | head -5
+		exit 1
+	fi
+done
+
+#############################
+# Symbols and relocations : file.sym gives the relocations as they are solved, the listing in address
+# order. Each table is compared sorted.
+#############################
+tables() {
+	awk '
+		/^\.symtab/ { table = "symtab"; next }
+		/^rel\./ { table = $1; next }
+		table != "" && NF > 0 { print table "\t" $0 }
+	' "$1" | sort
+}
+
+tables source.l > listing.sym
+tables file.sym > stream.sym
+
+if [ ! -s listing.sym ] || ! cmp -s listing.sym stream.sym
+then
+	echo "streamTest : file.sym differs from the listing"
+	diff listing.sym stream.sym | head -5
+	exit 1
+fi
+
+echo "streamTest : -s gives the bytes, symbols and relocations of the listing ($(wc -l < listing.text) bytes of code)"
+
+#############################
+# Memory : the smallest limit of virtual memory (ulimit -v, in MB) in which -s assembles the source, then
+# about 17 MB of .byte and .half lines in the same limit and a small margin.
+#############################
+for (( limit = 2; limit <= 256; limit++ ))
+do
+	( ulimit -v $(( limit * 1024 )) && "$AS_MIPS" -s source.s > /dev/null 2>&1 ) && break
+done
+
+if [ $limit -gt 256 ]
+then
+	echo "streamTest : memory not checked, ulimit -v does not work here"
+	exit 0
+fi
+
+{
+	echo ".data"
+	yes "	.half `yes 1 | head -n 300 | paste -sd, -`" | head -n 10000
+	yes "	.byte `yes 2 | head -n 300 | paste -sd, -`" | head -n 20000
+} > values.s
+
+if ! ( ulimit -v $(( ( limit + 4 ) * 1024 )) && "$AS_MIPS" -s values.s > /dev/null 2>&1 )
+then
+	echo "streamTest : -s needs more than $(( limit + 4 )) MB for $(( $(wc -c < values.s) / 1048576 )) MB of .byte and .half"
+	exit 1
+fi
+
+echo "streamTest : -s assembles $(( $(wc -c < values.s) / 1048576 )) MB of .byte and .half in $(( limit + 4 )) MB"
+exit 0
@@ -0,0 +1,389 @@
+/**
+ * @file genfsm.c
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief Lexeme FSM generator.
+ *
+ * Reads the readable description of the lexeme FSM (lexFSM.txt) and writes it as tables :
+ * a 256-entry character class map, a state x class transition table, and for the bulk scanner,
+ * the list of separator characters and the states that loop on every other character.
+ * Usage : genfsm lexFSM.txt src/lexfsm.c include/lexfsm.h
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#define MAX_NAMES   64
+#define NAMELEN     32
+#define LINELEN     1024
+
+static char classes[MAX_NAMES][NAMELEN];
+static int nclasses = 1; /* class 0 is OTHER */
+
+static char states[MAX_NAMES][NAMELEN];
+static char accept[MAX_NAMES][NAMELEN];
+static int nstates = 0;
+
+static int map[256];
+static int next[MAX_NAMES][MAX_NAMES];
+static int separator[MAX_NAMES];
+
+static char * spec = NULL;
+static int nline = 0;
+
+/**
+ * @brief Print an error about the spec file and stop.
+ */
+
+static void fail( char * msg, char * what ) {
+	fprintf( stderr, "%s:%d: %s %s\n", spec, nline, msg, what );
+	exit( EXIT_FAILURE );
+}
+
+/**
+ * @return Index of the name in the table, -1 if not found.
+ */
+
+static int find( char names[][NAMELEN], int n, char * name ) {
+	int i;
+
+	for ( i = 0; i < n; i++ ) {
+		if ( !strcmp( names[i], name ) ) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+/**
+ * @return The character written by a class item : a character or an escape.
+ */
+
+static int item_char( char * item ) {
+
+	if ( item[0] == '\\' && item[1] != '\0' ) {
+		switch ( item[1] ) {
+			case 's' : return ' ';
+			case 't' : return '\t';
+			case 'n' : return '\n';
+			default  : return (unsigned char) item[1];
+		}
+	}
+
+	return (unsigned char) item[0];
+}
+
+/**
+ * @brief class NAME items...
+ */
+
+static void read_class( char * name ) {
+	char * item;
+	int c;
+
+	if ( name == NULL ) {
+		fail( "missing class name", "" );
+	}
+
+	if ( nclasses == MAX_NAMES ) {
+		fail( "too many classes", name );
+	}
+
+	strncpy( classes[nclasses], name, NAMELEN-1 );
+
+	while ( (item = strtok( NULL, " \t" )) != NULL ) {
+
+		if ( strlen( item ) == 3 && item[1] == '-' ) {
+			for ( c = (unsigned char) item[0]; c <= (unsigned char) item[2]; c++ ) {
+				map[c] = nclasses;
+			}
+		}
+		else {
+			map[item_char( item )] = nclasses;
+		}
+	}
+
+	nclasses++;
+}
+
+/**
+ * @brief state NAME LEXEME
+ */
+
+static void read_state( char * name ) {
+	char * lexeme = strtok( NULL, " \t" );
+
+	if ( name == NULL || lexeme == NULL ) {
+		fail( "missing lexeme of state", name ? name : "" );
+	}
+
+	if ( nstates == MAX_NAMES ) {
+		fail( "too many states", name );
+	}
+
+	strncpy( states[nstates], name, NAMELEN-1 );
+	strncpy( accept[nstates], lexeme, NAMELEN-1 );
+	nstates++;
+}
+
+/**
+ * @brief separators CLASS...
+ */
+
+static void read_separators( void ) {
+	char * item;
+	int i;
+
+	while ( (item = strtok( NULL, " \t" )) != NULL ) {
+
+		if ( (i = find( classes, nclasses, item )) < 0 ) {
+			fail( "unknown class", item );
+		}
+
+		separator[i] = 1;
+	}
+}
+
+/**
+ * @return 1 if the state goes back to itself on every class which is not a separator.
+ */
+
+static int loops( int state ) {
+	int i;
+
+	for ( i = 0; i < nclasses; i++ ) {
+		if ( !separator[i] && next[state][i] != state ) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * @brief FROM CLASS... > TO. A "*" written first gives the default transition of the state.
+ */
+
+static void read_transition( char * name ) {
+	int from = find( states, nstates, name );
+	int to;
+	int given[MAX_NAMES] = {0};
+	int dflt = 0;
+	int i;
+	char * item;
+
+	if ( from < 0 ) {
+		fail( "unknown state", name );
+	}
+
+	while ( (item = strtok( NULL, " \t" )) != NULL && strcmp( item, ">" ) ) {
+
+		if ( !strcmp( item, "*" ) ) {
+			dflt = 1;
+		}
+		else if ( (i = find( classes, nclasses, item )) >= 0 ) {
+			given[i] = 1;
+		}
+		else {
+			fail( "unknown class", item );
+		}
+	}
+
+	if ( item == NULL || (item = strtok( NULL, " \t" )) == NULL ) {
+		fail( "missing target state after", name );
+	}
+
+	if ( (to = find( states, nstates, item )) < 0 ) {
+		fail( "unknown state", item );
+	}
+
+	/* Listed classes always win, "*" only fills the classes of this state that are still free */
+	for ( i = 0; i < nclasses; i++ ) {
+		if ( given[i] || (dflt && next[from][i] < 0) ) {
+			next[from][i] = to;
+		}
+	}
+}
+
+/**
+ * @brief Print a name in upper case, used to build enum names.
+ */
+
+static void upper( FILE * fp, char * prefix, char * name ) {
+	fputs( prefix, fp );
+
+	while ( *name ) {
+		fputc( toupper( (unsigned char) *name++ ), fp );
+	}
+}
+
+/**
+ * @brief Write the enums of classes and states, and the table declarations.
+ */
+
+static void write_header( char * file ) {
+	FILE * fp = fopen( file, "w" );
+	int i;
+
+	if ( fp == NULL ) {
+		fail( "can not write", file );
+	}
+
+	fprintf( fp, "/**\n * @file lexfsm.h\n * @brief Lexeme FSM tables.\n *\n" );
+	fprintf( fp, " * Generated by tools/genfsm from %s. Do not edit : change the spec and run \"make tables\".\n */\n\n", spec );
+	fprintf( fp, "#ifndef _LEXFSM_H_\n#define _LEXFSM_H_\n\n" );
+
+	fprintf( fp, "/* Character classes */\nenum {" );
+	for ( i = 0; i < nclasses; i++ ) {
+		fprintf( fp, "%s", i ? ", " : " " );
+		upper( fp, "CLASS_", classes[i] );
+	}
+	fprintf( fp, ", LEX_CLASSES };\n\n" );
+
+	fprintf( fp, "/* States, the first one is the initial state */\nenum {" );
+	for ( i = 0; i < nstates; i++ ) {
+		fprintf( fp, "%s", i ? ", " : " " );
+		upper( fp, "STATE_", states[i] );
+	}
+	fprintf( fp, ", LEX_STATES };\n\n" );
+
+	fprintf( fp, "extern const unsigned char lex_class[256];\n" );
+	fprintf( fp, "extern const unsigned char lex_next[LEX_STATES][LEX_CLASSES];\n" );
+	fprintf( fp, "extern const unsigned char lex_accept[LEX_STATES];\n" );
+	fprintf( fp, "extern const unsigned char lex_loop[LEX_STATES];\n" );
+	fprintf( fp, "extern const unsigned char lex_separator[256];\n" );
+	fprintf( fp, "extern const char lex_separators[];\n\n" );
+	fprintf( fp, "#endif /* _LEXFSM_H_ */\n" );
+
+	fclose( fp );
+}
+
+/**
+ * @brief Write the class map, the transition table, the lexeme of each state and the bulk scanner data.
+ */
+
+static void write_tables( char * file ) {
+	FILE * fp = fopen( file, "w" );
+	int i, j;
+
+	if ( fp == NULL ) {
+		fail( "can not write", file );
+	}
+
+	fprintf( fp, "/**\n * @file lexfsm.c\n * @brief Lexeme FSM tables.\n *\n" );
+	fprintf( fp, " * Generated by tools/genfsm from %s. Do not edit : change the spec and run \"make tables\".\n */\n\n", spec );
+	fprintf( fp, "#include <global.h>\n#include <lexfsm.h>\n\n" );
+
+	fprintf( fp, "/* Class of each byte */\nconst unsigned char lex_class[256] = {" );
+	for ( i = 0; i < 256; i++ ) {
+		fprintf( fp, "%s%2d%s", i % 16 ? "" : "\n\t", map[i], i < 255 ? "," : "" );
+	}
+	fprintf( fp, "\n};\n\n" );
+
+	fprintf( fp, "/* Next state, indexed by [state][class] */\nconst unsigned char lex_next[LEX_STATES][LEX_CLASSES] = {\n" );
+	for ( i = 0; i < nstates; i++ ) {
+		fprintf( fp, "\t{" );
+		for ( j = 0; j < nclasses; j++ ) {
+			if ( next[i][j] < 0 ) {
+				nline = 0;
+				fail( "no transition from state", states[i] );
+			}
+			fprintf( fp, "%s%2d", j ? "," : " ", next[i][j] );
+		}
+		fprintf( fp, " }%s /* %s */\n", i < nstates-1 ? "," : "", states[i] );
+	}
+	fprintf( fp, "};\n\n" );
+
+	fprintf( fp, "/* Lexeme produced when a token ends in each state */\nconst unsigned char lex_accept[LEX_STATES] = {" );
+	for ( i = 0; i < nstates; i++ ) {
+		fprintf( fp, "%s%s", i ? ", " : " ", accept[i] );
+	}
+	fprintf( fp, " };\n\n" );
+
+	fprintf( fp, "/* TRUE if the state loops on every character which is not a separator */\nconst unsigned char lex_loop[LEX_STATES] = {" );
+	for ( i = 0; i < nstates; i++ ) {
+		fprintf( fp, "%s%s", i ? ", " : " ", loops( i ) ? "TRUE" : "FALSE" );
+	}
+	fprintf( fp, " };\n\n" );
+
+	fprintf( fp, "/* TRUE if the byte is in a separator class */\nconst unsigned char lex_separator[256] = {" );
+	for ( i = 0; i < 256; i++ ) {
+		fprintf( fp, "%s%d%s", i % 32 ? "" : "\n\t", separator[map[i]], i < 255 ? "," : "" );
+	}
+	fprintf( fp, "\n};\n\n" );
+
+	fprintf( fp, "/* Characters of the separator classes */\nconst char lex_separators[] = \"" );
+	for ( i = 1; i < 256; i++ ) {
+		if ( separator[map[i]] ) {
+			if ( isgraph( i ) && i != '\\' && i != '"' ) {
+				fputc( i, fp );
+			}
+			else {
+				fprintf( fp, "\\%03o", i );
+			}
+		}
+	}
+	fprintf( fp, "\";\n" );
+
+	fclose( fp );
+}
+
+int main( int argc, char * argv[] ) {
+	FILE * fp;
+	char buffer[LINELEN];
+	char * token;
+	int i, j;
+
+	if ( argc != 4 ) {
+		fprintf( stderr, "Usage: %s spec.txt tables.c tables.h\n", argv[0] );
+		exit( EXIT_FAILURE );
+	}
+
+	spec = argv[1];
+	strcpy( classes[0], "OTHER" );
+
+	for ( i = 0; i < MAX_NAMES; i++ ) {
+		for ( j = 0; j < MAX_NAMES; j++ ) {
+			next[i][j] = -1;
+		}
+	}
+
+	fp = fopen( spec, "r" );
+
+	if ( fp == NULL ) {
+		fail( "can not read", spec );
+	}
+
+	while ( fgets( buffer, LINELEN, fp ) != NULL ) {
+		nline++;
+		buffer[strcspn( buffer, "\r\n" )] = '\0';
+
+		token = strtok( buffer, " \t" );
+
+		if ( token == NULL || token[0] == '#' ) {
+			continue;
+		}
+
+		if ( !strcmp( token, "class" ) ) {
+			read_class( strtok( NULL, " \t" ) );
+		}
+		else if ( !strcmp( token, "separators" ) ) {
+			read_separators();
+		}
+		else if ( !strcmp( token, "state" ) ) {
+			read_state( strtok( NULL, " \t" ) );
+		}
+		else {
+			read_transition( token );
+		}
+	}
+
+	fclose( fp );
+
+	write_tables( argv[2] );
+	write_header( argv[3] );
+
+	return EXIT_SUCCESS;
+}
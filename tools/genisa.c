@@ -0,0 +1,591 @@
+/**
+ * @file genisa.c
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief Instruction set generator.
+ *
+ * Reads the instruction set (instSet.txt) and writes it as read only data, with a minimal perfect hash
+ * of the upper case mnemonics : every mnemonic gets its own slot in [0, nkeys), so that a lookup is one
+ * hash and one compare. Names that only differ by case (Lw and LW) share their slot.
+ * The hash is FNV-1a on the upper case name, spread over the slots with one displacement per bucket
+ * (hash and displace) : buckets are placed biggest first, each one with the first displacement that
+ * sends all its names to free slots.
+ * The set is written as C source, compiled in as-mips, or with -b as a table file for as-mips --isa.
+ * Usage : genisa instSet.txt src/isahash.c include/isahash.h
+ *         genisa -b instSet.txt table.isa
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include <global.h>
+
+#define MAX_KEYS    1024
+#define NAMELEN     16
+#define LINELEN     1024
+
+/* Number of displacements tried for a bucket before giving up */
+#define MAX_DISP    65536
+
+/* Instructions as read, and the upper case name of each one */
+static struct inst_t insts[MAX_KEYS];
+static int key[MAX_KEYS];
+
+/* TRUE if the instruction is followed by the one named like it with a final '*' */
+static int chained[MAX_KEYS];
+
+/* Operand digits of each instruction, as written */
+static char operand[MAX_KEYS][8];
+static int ninsts = 0;
+
+/* Operands of each type which are registers, bit k for the k-th digit : rs rt rd (R), rs rt (I, IB, I2) */
+static const unsigned int registers[] = { 0x7, 0x3, 0x0, 0x3, 0x3 };
+
+static char keys[MAX_KEYS][NAMELEN];
+static unsigned int hashes[MAX_KEYS];
+static int nkeys = 0;
+
+static int nbuckets = 0;
+static unsigned int disp[MAX_KEYS];
+static int order[MAX_KEYS];
+static int bsize[MAX_KEYS];
+static int slot[MAX_KEYS];
+
+/* Instructions in their final order : the one of each slot, then the other spellings */
+static struct inst_t set[MAX_KEYS];
+static int where[MAX_KEYS];
+
+static char * spec = NULL;
+static int nline = 0;
+
+/**
+ * @brief Print an error about the spec file and stop.
+ */
+
+static void fail( char * msg, char * what ) {
+	fprintf( stderr, "%s:%d: %s %s\n", spec, nline, msg, what );
+	exit( EXIT_FAILURE );
+}
+
+/**
+ * @return FNV-1a hash of the upper case name.
+ */
+
+static unsigned int hash( char * s ) {
+	unsigned int h = 2166136261U;
+
+	while ( *s ) {
+		h = ( h ^ (unsigned char) toupper( (unsigned char) *s++ ) ) * 16777619U;
+	}
+
+	return h;
+}
+
+/**
+ * @return Slot of a name of hash h, moved by the displacement of its bucket. hash() and place() must
+ * compute what the lookup of src/inst.c does.
+ */
+
+static int place( unsigned int h, unsigned int d ) {
+	h = ( h ^ d * 0x9E3779B9U ) * 0x85EBCA6BU;
+
+	return ( h >> 16 ) % nkeys;
+}
+
+/**
+ * @brief The value of a special operand : a letter gives an operand of the source (A is the first),
+ * bits a constant, a register if the field is one.
+ */
+
+static void compile_value( struct special_t * sp, char * value, int reg ) {
+	unsigned int v;
+
+	if ( value == NULL ) {
+		fail( "missing value of a special operand", "" );
+	}
+
+	if ( value[0] >= 'A' && value[0] < 'Z' && value[1] == '\0' ) {
+		sp->source = value[0] - 'A';
+		return;
+	}
+
+	if ( value[0] == '\0' || strspn( value, "01" ) != strlen( value ) || strlen( value ) > 32 ) {
+		fail( "special operand is neither an operand nor bits :", value );
+	}
+
+	sp->source = -1;
+	sp->lexeme.type = reg ? REGISTER : BIT;
+	sp->lexeme.this.value = strtoul( value, NULL, 2 );
+
+	/* Width of the constant, as the lexer gives it for a number (see literal.c) */
+	sp->lexeme.sign = UNSIGNED;
+	sp->lexeme.bits = 0;
+
+	for ( v = sp->lexeme.this.value; v; v >>= 1 ) {
+		sp->lexeme.bits++;
+	}
+
+	if ( sp->lexeme.type == REGISTER && sp->lexeme.this.value > 31 ) {
+		fail( "bad register", value );
+	}
+}
+
+/**
+ * @return TRUE if the operand at this position of the operand bits is expected, like atoi( &operand[pos] ).
+ */
+
+static int expected( char * operand, unsigned int pos ) {
+	return pos < strlen( operand ) && atoi( &operand[pos] ) != 0;
+}
+
+/**
+ * @brief [*,]field=value,... The fields are taken in the order in which the encoder of the type reads
+ * its operands, each one if the type expects it : rd rs rt sa (R), rt rs offset (I), rt offset rs (IB),
+ * offset (J). "*" chains the instruction named like this one with a final '*'.
+ */
+
+static void compile( char * special ) {
+	static const char * names[][INST_SPECIALS] = {
+		{ "rd", "rs", "rt", "sa" }, { "rt", "rs", "offset", NULL }, { "offset", NULL, NULL, NULL }, { "rt", "offset", "rs", NULL } };
+	static const unsigned int pos[][INST_SPECIALS] = { { 2, 0, 1, 3 }, { 1, 0, 2, 0 }, { 0, 0, 0, 0 }, { 1, 2, 0, 0 } };
+	struct inst_t * ins = &insts[ninsts];
+	char * result[16];
+	int n = 0, j = 0, f;
+
+	for ( result[n] = strtok( special, ",=" ); result[n] != NULL && n < 15; result[++n] = strtok( NULL, ",=" ) );
+
+	if ( n > 0 && result[0][0] == '*' ) {
+		chained[ninsts] = 1;
+		j++;
+	}
+
+	if ( ins->type < R || ins->type > IB ) {
+		fail( "no special operands for the type of", ins->name );
+	}
+
+	ins->nspecials = 0;
+
+	for ( f = 0; f < INST_SPECIALS && names[ins->type][f] != NULL; f++ ) {
+
+		if ( j < n && expected( operand[ninsts], pos[ins->type][f] ) && !strcmp( result[j], names[ins->type][f] ) ) {
+			compile_value( &ins->specials[ins->nspecials++], result[j+1], ( registers[ins->type] >> pos[ins->type][f] ) & 1 );
+			j += 2;
+		}
+	}
+}
+
+/**
+ * @brief Copy a field of a line, checking its length.
+ */
+
+static void field( char * to, size_t size, char * from, char * what ) {
+
+	if ( from == NULL ) {
+		fail( "missing", what );
+	}
+
+	if ( strlen( from ) >= size || strpbrk( from, "\"\\" ) != NULL ) {
+		fail( "bad", what );
+	}
+
+	strcpy( to, from );
+}
+
+/**
+ * @brief NAME OPCODE TYPE OPERANDS [SPECIAL]. The upper case name is added to the keys, once.
+ */
+
+static void read_inst( char * name ) {
+	struct inst_t * ins = &insts[ninsts];
+	char upper[NAMELEN];
+	char * type;
+	char * special;
+	int i;
+
+	if ( ninsts == MAX_KEYS ) {
+		fail( "too many mnemonics", name );
+	}
+
+	field( ins->name, sizeof( ins->name ), name, "mnemonic" );
+	field( ins->opcode, sizeof( ins->opcode ), strtok( NULL, " \t" ), "opcode" );
+
+	if ( strspn( ins->opcode, "01" ) != strlen( ins->opcode ) || strlen( ins->opcode ) > 6 ) {
+		fail( "opcode is not 6 bits :", ins->opcode );
+	}
+
+	ins->op = strtoul( ins->opcode, NULL, 2 );
+
+	if ( (type = strtok( NULL, " \t" )) == NULL || !isdigit( (unsigned char) type[0] ) ) {
+		fail( "missing type of", name );
+	}
+
+	ins->type = atoi( type );
+	field( operand[ninsts], sizeof( operand[ninsts] ), strtok( NULL, " \t" ), "operands" );
+
+	/* Bit k : the k-th operand is waited */
+	ins->operands = 0;
+	for ( i = 0; operand[ninsts][i]; i++ ) {
+		if ( operand[ninsts][i] != '0' ) {
+			ins->operands |= 1U << i;
+		}
+	}
+
+	if ( ins->type < R || ins->type > I2 ) {
+		fail( "bad type of", name );
+	}
+
+	ins->registers = ins->operands & registers[ins->type];
+	ins->alt = -1;
+	ins->next = -1;
+	ins->nspecials = -1;
+
+	if ( (special = strtok( NULL, " \t" )) != NULL && special[0] != '#' ) {
+		compile( special );
+	}
+
+	for ( i = 0; name[i]; i++ ) {
+		upper[i] = toupper( (unsigned char) name[i] );
+	}
+	upper[i] = '\0';
+
+	for ( i = 0; i < nkeys && strcmp( keys[i], upper ); i++ );
+
+	if ( i == nkeys ) {
+		strcpy( keys[nkeys], upper );
+		hashes[nkeys] = hash( upper );
+		nkeys++;
+	}
+
+	key[ninsts++] = i;
+}
+
+/**
+ * @brief Biggest buckets first.
+ */
+
+static int by_size( const void * a, const void * b ) {
+	return bsize[*(const int *) b] - bsize[*(const int *) a];
+}
+
+/**
+ * @brief Find a displacement for each bucket so that every name has a slot of its own.
+ */
+
+static void build( void ) {
+	int used[MAX_KEYS];
+	int taken[MAX_KEYS];
+	int b, i, k, n, s;
+	unsigned int d;
+
+	nbuckets = nkeys;
+
+	for ( i = 0; i < nkeys; i++ ) {
+		bsize[hashes[i] % nbuckets]++;
+		used[i] = -1;
+	}
+
+	for ( b = 0; b < nbuckets; b++ ) {
+		order[b] = b;
+	}
+
+	qsort( order, nbuckets, sizeof( *order ), by_size );
+
+	for ( b = 0; b < nbuckets && bsize[order[b]] > 0; b++ ) {
+
+		for ( d = 0; d < MAX_DISP; d++ ) {
+			n = 0;
+
+			for ( k = 0; k < nkeys; k++ ) {
+				if ( (int) ( hashes[k] % nbuckets ) != order[b] ) {
+					continue;
+				}
+
+				s = place( hashes[k], d );
+
+				for ( i = 0; i < n && taken[i] != s; i++ );
+
+				if ( used[s] >= 0 || i < n ) {
+					break;
+				}
+
+				slot[k] = s;
+				taken[n++] = s;
+			}
+
+			if ( k == nkeys ) {
+				break;
+			}
+		}
+
+		if ( d == MAX_DISP ) {
+			for ( k = 0; (int) ( hashes[k] % nbuckets ) != order[b]; k++ );
+			nline = 0;
+			fail( "no displacement found for the bucket of", keys[k] );
+		}
+
+		disp[order[b]] = d;
+
+		for ( k = 0; k < nkeys; k++ ) {
+			if ( (int) ( hashes[k] % nbuckets ) == order[b] ) {
+				used[slot[k]] = k;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Put the instruction of each slot in its slot, the one with the upper case name if there are
+ * several spellings, and chain the other spellings after the slots.
+ */
+
+static void arrange( void ) {
+	int first[MAX_KEYS];
+	int last[MAX_KEYS];
+	int i, k, n = nkeys;
+
+	for ( k = 0; k < nkeys; k++ ) {
+		first[k] = -1;
+	}
+
+	for ( i = 0; i < ninsts; i++ ) {
+		k = key[i];
+
+		if ( first[k] < 0 || ( !strcmp( insts[i].name, keys[k] ) && strcmp( insts[first[k]].name, keys[k] ) ) ) {
+			first[k] = i;
+		}
+	}
+
+	for ( k = 0; k < nkeys; k++ ) {
+		set[slot[k]] = insts[first[k]];
+		where[first[k]] = slot[k];
+		last[k] = slot[k];
+	}
+
+	for ( i = 0; i < ninsts; i++ ) {
+		k = key[i];
+
+		if ( i != first[k] ) {
+			set[n] = insts[i];
+			where[i] = n;
+			set[last[k]].alt = n;
+			last[k] = n++;
+		}
+	}
+}
+
+/**
+ * @return TRUE if the names only differ by case.
+ */
+
+static int same( char * a, char * b ) {
+
+	while ( *a && toupper( (unsigned char) *a ) == toupper( (unsigned char) *b ) ) {
+		a++;
+		b++;
+	}
+
+	return *a == *b;
+}
+
+/**
+ * @brief Link each chained instruction to the one that follows it : same name with a final '*', exact
+ * spelling first.
+ */
+
+static void link( void ) {
+	char name[NAMELEN + 1];
+	int i, j, k;
+
+	for ( i = 0; i < ninsts; i++ ) {
+
+		if ( !chained[i] ) {
+			continue;
+		}
+
+		sprintf( name, "%s*", insts[i].name );
+
+		for ( j = 0; j < ninsts && strcmp( insts[j].name, name ); j++ );
+
+		if ( j == ninsts ) {
+			for ( j = 0; j < ninsts && !same( insts[j].name, name ); j++ );
+		}
+
+		if ( j == ninsts ) {
+			fail( "no instruction follows", insts[i].name );
+		}
+
+		set[where[i]].next = where[j];
+	}
+
+	/* The assembler expands a pseudo-instruction in a buffer of INST_EXPANSION instructions */
+	for ( i = 0; i < ninsts; i++ ) {
+
+		for ( j = 1, k = set[where[i]].next; k >= 0 && j <= INST_EXPANSION; j++, k = set[k].next );
+
+		if ( j > INST_EXPANSION ) {
+			fail( "expansion longer than INST_EXPANSION instructions, or looping, from", insts[i].name );
+		}
+	}
+}
+
+/**
+ * @brief Write the declaration of the built-in instruction set.
+ */
+
+static void write_header( char * file ) {
+	FILE * fp = fopen( file, "w" );
+
+	if ( fp == NULL ) {
+		fail( "can not write", file );
+	}
+
+	fprintf( fp, "/**\n * @file isahash.h\n * @brief Built-in instruction set and its perfect hash.\n *\n" );
+	fprintf( fp, " * Generated by tools/genisa from %s. Do not edit : change the spec and run \"make tables\".\n */\n\n", spec );
+	fprintf( fp, "#ifndef _ISAHASH_H_\n#define _ISAHASH_H_\n\n#include <global.h>\n\n" );
+	fprintf( fp, "extern struct isa_t isa_builtin;\n\n" );
+	fprintf( fp, "#endif /* _ISAHASH_H_ */\n" );
+
+	fclose( fp );
+}
+
+/**
+ * @brief Write the displacements, the instructions and the set that gathers them.
+ */
+
+static void write_tables( char * file ) {
+	FILE * fp = fopen( file, "w" );
+	struct inst_t * ins;
+	struct special_t * sp;
+	int i, j;
+
+	if ( fp == NULL ) {
+		fail( "can not write", file );
+	}
+
+	fprintf( fp, "/**\n * @file isahash.c\n * @brief Built-in instruction set and its perfect hash.\n *\n" );
+	fprintf( fp, " * Generated by tools/genisa from %s. Do not edit : change the spec and run \"make tables\".\n */\n\n", spec );
+	fprintf( fp, "#include <global.h>\n#include <isahash.h>\n\n" );
+
+	fprintf( fp, "/* Displacement of each bucket */\nstatic const unsigned short disp[%d] = {", nbuckets );
+	for ( i = 0; i < nbuckets; i++ ) {
+		fprintf( fp, "%s%5u%s", i % 8 ? "" : "\n\t", disp[i], i < nbuckets-1 ? "," : "" );
+	}
+	fprintf( fp, "\n};\n\n" );
+
+	fprintf( fp, "/* Instruction of each slot, then the other spellings :\n" );
+	fprintf( fp, "   name, opcode, type, operand mask, register mask, special operands (-1 : none), next instruction, next spelling */\n" );
+	fprintf( fp, "static const struct inst_t set[%d] = {\n", ninsts );
+	for ( i = 0; i < ninsts; i++ ) {
+		ins = &set[i];
+		fprintf( fp, "\t{ \"%s\", \"%s\", %u, %d, 0x%X, 0x%X, %d, {", ins->name, ins->opcode, ins->op, ins->type, ins->operands, ins->registers, ins->nspecials );
+		for ( j = 0; j < ins->nspecials; j++ ) {
+			sp = &ins->specials[j];
+
+			if ( sp->source >= 0 ) {
+				fprintf( fp, "%s{ %d }", j ? ", " : " ", sp->source );
+			}
+			else {
+				fprintf( fp, "%s{ -1, { %s, %u, UNSIGNED, { %u } } }", j ? ", " : " ", sp->lexeme.type == REGISTER ? "REGISTER" : "BIT",
+					sp->lexeme.bits, sp->lexeme.this.value );
+			}
+		}
+		if ( ins->nspecials <= 0 ) {
+			fprintf( fp, " { 0 }" );
+		}
+		fprintf( fp, " }, %d, %d }%s\n", ins->next, ins->alt, i < ninsts-1 ? "," : "" );
+	}
+	fprintf( fp, "};\n\n" );
+
+	fprintf( fp, "struct isa_t isa_builtin = { %d, %d, disp, %d, set, NULL, 0 };\n", nkeys, nbuckets, ninsts );
+
+	fclose( fp );
+}
+
+/**
+ * @brief Write the set as a table file, which as-mips --isa maps instead of its built-in set.
+ */
+
+static void write_binary( char * file ) {
+	FILE * fp = fopen( file, "wb" );
+	struct isa_file_t header;
+	unsigned short d;
+	int i;
+
+	if ( fp == NULL ) {
+		fail( "can not write", file );
+	}
+
+	memset( &header, 0, sizeof( header ) );
+	memcpy( header.magic, ISA_MAGIC, sizeof( header.magic ) );
+	header.entry = sizeof( struct inst_t );
+	header.nkeys = nkeys;
+	header.nbuckets = nbuckets;
+	header.ninst = ninsts;
+
+	fwrite( &header, sizeof( header ), 1, fp );
+	fwrite( set, sizeof( *set ), ninsts, fp );
+
+	for ( i = 0; i < nbuckets; i++ ) {
+		d = disp[i];
+		fwrite( &d, sizeof( d ), 1, fp );
+	}
+
+	if ( fclose( fp ) != 0 ) {
+		fail( "can not write", file );
+	}
+}
+
+int main( int argc, char * argv[] ) {
+	FILE * fp;
+	char buffer[LINELEN];
+	char * token;
+	int binary = ( argc == 4 && !strcmp( argv[1], "-b" ) );
+
+	if ( argc != 4 ) {
+		fprintf( stderr, "Usage: %s instSet.txt tables.c tables.h\n", argv[0] );
+		fprintf( stderr, "       %s -b instSet.txt table.isa\n", argv[0] );
+		exit( EXIT_FAILURE );
+	}
+
+	spec = argv[binary ? 2 : 1];
+	fp = fopen( spec, "r" );
+
+	if ( fp == NULL ) {
+		fail( "can not read", spec );
+	}
+
+	while ( fgets( buffer, LINELEN, fp ) != NULL ) {
+		nline++;
+		buffer[strcspn( buffer, "\r\n" )] = '\0';
+
+		token = strtok( buffer, " \t" );
+
+		if ( token == NULL || token[0] == '#' ) {
+			continue;
+		}
+
+		read_inst( token );
+	}
+
+	fclose( fp );
+
+	if ( nkeys == 0 ) {
+		fail( "no mnemonic in", spec );
+	}
+
+	nline = 0;
+	build();
+	arrange();
+	link();
+
+	if ( binary ) {
+		write_binary( argv[3] );
+	}
+	else {
+		write_tables( argv[2] );
+		write_header( argv[3] );
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,250 @@
+/**
+ * @file genreg.c
+ * @author Ayoub Bargach <ayoub.bargach@phelma.grenoble-inp.fr>
+ * @brief Register name trie generator.
+ *
+ * Reads the register names (registers.txt) and writes them as a trie : a character class map, a
+ * state x class transition table and the register of each state. Reading a name is one table
+ * access per character, whatever the name, and a name which is not listed ends in a state without
+ * register.
+ * Usage : genreg registers.txt src/regtrie.c include/regtrie.h
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include <global.h>
+
+#define MAX_STATES  256
+#define LINELEN     1024
+
+/* Class 0 is any other character, then the digits and the lower case letters */
+#define CLASSES     ( 1 + 10 + 26 )
+
+/* State 0 is a dead end, state 1 is the state after '$' */
+#define DEAD        0
+#define ROOT        1
+
+static int next[MAX_STATES][CLASSES];
+static int value[MAX_STATES];
+static int nstates = 2;
+
+static char * spec = NULL;
+static int nline = 0;
+
+/**
+ * @brief Print an error about the spec file and stop.
+ */
+
+static void fail( char * msg, char * what ) {
+	fprintf( stderr, "%s:%d: %s %s\n", spec, nline, msg, what );
+	exit( EXIT_FAILURE );
+}
+
+/**
+ * @return The class of a character.
+ */
+
+static int class_of( int c ) {
+
+	if ( c >= '0' && c <= '9' ) {
+		return 1 + c - '0';
+	}
+
+	if ( c >= 'a' && c <= 'z' ) {
+		return 11 + c - 'a';
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Add a name, without its '$', to the trie.
+ */
+
+static void add( char * name, int number ) {
+	int state = ROOT;
+	int c;
+
+	for ( ; *name; name++ ) {
+
+		if ( (c = class_of( (unsigned char) *name )) == 0 ) {
+			fail( "register names are digits and lower case letters :", name );
+		}
+
+		if ( next[state][c] == DEAD ) {
+
+			if ( nstates == MAX_STATES ) {
+				fail( "too many states at", name );
+			}
+
+			value[nstates] = -1;
+			next[state][c] = nstates++;
+		}
+
+		state = next[state][c];
+	}
+
+	if ( value[state] >= 0 && value[state] != number ) {
+		fail( "register given twice :", name );
+	}
+
+	value[state] = number;
+}
+
+/**
+ * @brief NAME NUMBER or NAMEa-b FIRST, an 'f' before the number for the coprocessor registers.
+ */
+
+static void read_register( char * name ) {
+	char * number = strtok( NULL, " \t" );
+	char * range;
+	char prefix[LINELEN];
+	char full[LINELEN + 16];
+	int flag = 0;
+	int first, last, n;
+
+	if ( name[0] != '$' || number == NULL ) {
+		fail( "expected $NAME NUMBER, not", name );
+	}
+
+	if ( number[0] == 'f' ) {
+		flag = REGISTER_FP;
+		number++;
+	}
+
+	if ( !isdigit( (unsigned char) number[0] ) || (n = atoi( number )) > 31 ) {
+		fail( "bad register number", number );
+	}
+
+	/* Range : the digits before '-' start it */
+	if ( (range = strchr( name, '-' )) != NULL ) {
+		last = atoi( range + 1 );
+
+		for ( first = range - name; first > 1 && isdigit( (unsigned char) name[first-1] ); first-- );
+
+		strncpy( prefix, name + 1, first - 1 );
+		prefix[first - 1] = '\0';
+		first = atoi( name + first );
+
+		if ( first > last || n + last - first > 31 ) {
+			fail( "bad range", name );
+		}
+
+		for ( ; first <= last; first++, n++ ) {
+			sprintf( full, "%s%d", prefix, first );
+			add( full, n | flag );
+		}
+	}
+	else {
+		add( name + 1, n | flag );
+	}
+}
+
+/**
+ * @brief Write the sizes of the tables and their declarations.
+ */
+
+static void write_header( char * file ) {
+	FILE * fp = fopen( file, "w" );
+
+	if ( fp == NULL ) {
+		fail( "can not write", file );
+	}
+
+	fprintf( fp, "/**\n * @file regtrie.h\n * @brief Register name trie.\n *\n" );
+	fprintf( fp, " * Generated by tools/genreg from %s. Do not edit : change the spec and run \"make tables\".\n */\n\n", spec );
+	fprintf( fp, "#ifndef _REGTRIE_H_\n#define _REGTRIE_H_\n\n" );
+	fprintf( fp, "#define REG_CLASSES %d\n#define REG_STATES %d\n\n", CLASSES, nstates );
+	fprintf( fp, "/* State after '$', and dead end */\n#define REG_ROOT %d\n#define REG_DEAD %d\n\n", ROOT, DEAD );
+	fprintf( fp, "extern const unsigned char reg_class[256];\n" );
+	fprintf( fp, "extern const unsigned char reg_next[REG_STATES][REG_CLASSES];\n" );
+	fprintf( fp, "extern const signed char reg_value[REG_STATES];\n\n" );
+	fprintf( fp, "#endif /* _REGTRIE_H_ */\n" );
+
+	fclose( fp );
+}
+
+/**
+ * @brief Write the class map, the transition table and the register of each state.
+ */
+
+static void write_tables( char * file ) {
+	FILE * fp = fopen( file, "w" );
+	int i, j;
+
+	if ( fp == NULL ) {
+		fail( "can not write", file );
+	}
+
+	fprintf( fp, "/**\n * @file regtrie.c\n * @brief Register name trie.\n *\n" );
+	fprintf( fp, " * Generated by tools/genreg from %s. Do not edit : change the spec and run \"make tables\".\n */\n\n", spec );
+	fprintf( fp, "#include <regtrie.h>\n\n" );
+
+	fprintf( fp, "/* Class of each byte */\nconst unsigned char reg_class[256] = {" );
+	for ( i = 0; i < 256; i++ ) {
+		fprintf( fp, "%s%2d%s", i % 16 ? "" : "\n\t", class_of( i ), i < 255 ? "," : "" );
+	}
+	fprintf( fp, "\n};\n\n" );
+
+	fprintf( fp, "/* Next state, indexed by [state][class] */\nconst unsigned char reg_next[REG_STATES][REG_CLASSES] = {\n" );
+	for ( i = 0; i < nstates; i++ ) {
+		fprintf( fp, "\t{" );
+		for ( j = 0; j < CLASSES; j++ ) {
+			fprintf( fp, "%s%d", j ? "," : " ", next[i][j] );
+		}
+		fprintf( fp, " }%s\n", i < nstates-1 ? "," : "" );
+	}
+	fprintf( fp, "};\n\n" );
+
+	fprintf( fp, "/* Register of the name that ends in each state, -1 if none */\nconst signed char reg_value[REG_STATES] = {" );
+	for ( i = 0; i < nstates; i++ ) {
+		fprintf( fp, "%s%3d%s", i % 16 ? "" : "\n\t", value[i], i < nstates-1 ? "," : "" );
+	}
+	fprintf( fp, "\n};\n" );
+
+	fclose( fp );
+}
+
+int main( int argc, char * argv[] ) {
+	FILE * fp;
+	char buffer[LINELEN];
+	char * token;
+
+	if ( argc != 4 ) {
+		fprintf( stderr, "Usage: %s registers.txt tables.c tables.h\n", argv[0] );
+		exit( EXIT_FAILURE );
+	}
+
+	spec = argv[1];
+	value[DEAD] = -1;
+	value[ROOT] = -1;
+
+	fp = fopen( spec, "r" );
+
+	if ( fp == NULL ) {
+		fail( "can not read", spec );
+	}
+
+	while ( fgets( buffer, LINELEN, fp ) != NULL ) {
+		nline++;
+		buffer[strcspn( buffer, "\r\n" )] = '\0';
+
+		token = strtok( buffer, " \t" );
+
+		if ( token == NULL || token[0] == '#' ) {
+			continue;
+		}
+
+		read_register( token );
+	}
+
+	fclose( fp );
+
+	write_tables( argv[2] );
+	write_header( argv[3] );
+
+	return EXIT_SUCCESS;
+}